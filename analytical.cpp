@@ -0,0 +1,345 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  analytical.cpp
+ *
+ *    Description:  First-order queueing model of the heterogeneous memory system
+ *
+ *        Version:  1.0
+ *        Created:  06/26/2014 10:03:52 AM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <time.h>
+
+#include "analytical.h"
+#include "parallel.h"
+#include "dram.h"
+
+using namespace std;
+
+struct TierModel {
+	float lambda;  // Arrivals per cycle at one rank
+	float service; // Cycles per request
+	float rho;
+	float wait;    // Mean wait before service, wake-up included
+
+	// Shape of the wait for the tail : with probability asleep a fixed
+	// wake-up shift, then a uniform fill delay up to spread, then an
+	// exponential queueing delay (probability queued, mean queue_mean)
+	float asleep;
+	float shift;
+	float spread;
+	float queued;
+	float queue_mean;
+	float accesses;
+	float energy;
+};
+
+static float mdWait(float rho, float service) {
+	return rho * service / (2 * (1 - rho));
+}
+
+// Wake-up latency mixing power-down and self-refresh exits, first and
+// second moments
+static void wakeMoments(const Parameters &param, float lambda, unsigned long int sr_timeout, float &w1, float &w2) {
+	float sr = 0;
+	if(sr_timeout != 0) sr = exp(-lambda * sr_timeout);
+
+	float pd_exit = param.power_up_latency;
+	float sr_exit = param.self_refresh_latency;
+
+	w1 = (1 - sr) * pd_exit + sr * sr_exit;
+	w2 = (1 - sr) * pd_exit * pd_exit + sr * sr_exit * sr_exit;
+}
+
+// Probability a request to the fast type finds a strictly shorter bank
+// queue there, with geometric queue lengths
+static float fastShare(float rho0, float rho1) {
+	if(rho0 >= 1) return 0;
+	if(rho1 >= 1) return 1;
+	return (1 - rho0) * rho1 / (1 - rho0 * rho1);
+}
+
+static void modelTier(const SimConfig &config, const Parameters &param, float lambda, float lambda_wm,
+		TierModel &tier) {
+	const ControllerConfig &ctrl = config.ctrl;
+	float T = config.sim_time;
+
+	tier.lambda = lambda;
+	tier.service = param.latency + 1; // One cycle to pick the request up
+	tier.rho = lambda * tier.service;
+	tier.accesses = lambda * T;
+
+	float w1, w2;
+	wakeMoments(param, lambda, ctrl.sr_timeout, w1, w2);
+
+	// Queueing delay, finite-horizon backlog growth once saturated
+	float queue;
+	if(tier.rho < 1) {
+		queue = mdWait(tier.rho, tier.service);
+	} else {
+		queue = (1 - 1 / tier.rho) * T / 2 + tier.service;
+	}
+
+	float vacation = 0;
+	float wakes = 0; // Wake-ups over the run
+
+	tier.asleep = 0;
+	tier.shift = 0;
+	tier.spread = 0;
+	tier.queued = min(tier.rho, 1.0f);
+	tier.queue_mean = (tier.queued > 0) ? queue / tier.queued : 0;
+
+	if(ctrl.pd_policy == NONE || lambda == 0) {
+	} else if(ctrl.pd_policy == CONSERVATIVE && ctrl.sched_policy != BACKLOG) {
+		// Setup time paid by whoever finds the rank asleep
+		vacation = (2 * w1 + lambda * w2) / (2 * (1 + lambda * w1));
+		wakes = tier.accesses * max(0.0f, 1 - tier.rho) / (1 + lambda * w1);
+
+		tier.asleep = max(0.0f, 1 - tier.rho);
+		tier.shift = w1;
+	} else {
+		// Woken only once pd_wm requests are pending
+		float N = ctrl.pd_wm;
+		float fill = (N > 1) ? (N - 1) / lambda_wm : 0;
+
+		if(ctrl.pd_policy == CONSERVATIVE) {
+			vacation = (N * fill / 2 + N * w1 + lambda * w2 / 2) / (N + lambda * w1);
+			wakes = tier.accesses * max(0.0f, 1 - tier.rho) / (N + lambda * w1);
+
+			tier.spread = fill;
+			tier.shift = w1;
+		} else {
+			// WATERMARK sends the rank back down below the mark, so the
+			// queue hovers around pd_wm - 1
+			vacation = fill + w1;
+			wakes = tier.accesses / max(1.0f, N);
+
+			tier.shift = vacation;
+		}
+
+		if(ctrl.sched_policy == BACKLOG && ctrl.timeout != 0) {
+			vacation = min(vacation, (float) ctrl.timeout + w1);
+			tier.spread = min(tier.spread, (float) ctrl.timeout);
+			tier.shift = min(tier.shift, (float) ctrl.timeout + w1);
+		}
+		tier.asleep = 1;
+	}
+
+	tier.wait = queue + vacation;
+
+	// Energy over the measured window : generation plus the drain window
+	float window = 3 * T;
+	float active = tier.accesses * param.latency;
+	float idle = tier.accesses + wakes * w1;
+	if(ctrl.pd_policy == NONE) {
+		idle = window - active;
+	}
+	float asleep = max(0.0f, window - active - idle);
+
+	float self_refresh = 0;
+	if(ctrl.sr_timeout != 0 && ctrl.pd_policy != NONE) {
+		float tail = max(0.0f, 2 * T - ctrl.sr_timeout);
+		float during = (lambda > 0) ? wakes * exp(-lambda * ctrl.sr_timeout) / lambda : 0;
+		self_refresh = min(asleep, tail + during);
+	}
+
+	tier.energy = param.dynamic_power * tier.accesses
+		+ param.static_power * idle
+		+ param.power_down_power * (asleep - self_refresh)
+		+ param.self_refresh_power * self_refresh;
+}
+
+// P(fill + queueing delay > wait)
+static float waitTail(const TierModel &tier, float wait) {
+	if(wait < 0) return 1;
+
+	float p = 0;
+	if(wait < tier.spread) {
+		p += 1 - wait / tier.spread;
+	}
+	if(tier.queue_mean > 0) {
+		p += tier.queued * exp(-max(0.0f, wait - tier.spread) / tier.queue_mean);
+	}
+
+	return min(p, 1.0f);
+}
+
+void estimateAnalytical(const SimConfig &config, SimResult &result) {
+	const ControllerConfig &ctrl = config.ctrl;
+
+	Parameters param[NUM_TYPES];
+	for(int i=0; i < NUM_TYPES; i++) {
+		technologyParameters(i, param[i]);
+	}
+
+	float lambda = config.num_cores * config.mem_intensity / ctrl.num_ranks;
+	float flexible = max(0.0f, 1 - config.type1_intensity - config.type2_intensity);
+
+	// Where flexible requests land
+	float share0 = 0;
+	if(ctrl.sched_policy == COST) {
+		float cost[NUM_TYPES];
+		for(int i=0; i < NUM_TYPES; i++) {
+			float latency = param[i].latency + 1;
+			float energy = param[i].dynamic_power;
+			if(ctrl.pd_policy != NONE) {
+				latency += param[i].power_up_latency;
+				energy += param[i].static_power * param[i].power_up_latency;
+			}
+			cost[i] = pow(latency, ctrl.placement_weight) * pow(energy, 1 - ctrl.placement_weight);
+		}
+		share0 = (cost[0] < cost[1]) ? 1 : 0;
+	} else {
+		// Ties go to type 1, so only a strictly shorter queue attracts them
+		for(int iter=0; iter < 50; iter++) {
+			float rho0 = lambda * (config.type1_intensity + flexible * share0) * (param[0].latency + 1);
+			float rho1 = lambda * (config.type2_intensity + flexible * (1 - share0)) * (param[1].latency + 1);
+			share0 = 0.5 * share0 + 0.5 * fastShare(rho0, rho1);
+		}
+	}
+
+	// Watermarks also count pending flexible requests of the rank
+	TierModel tier[NUM_TYPES];
+	float lambda0 = lambda * (config.type1_intensity + flexible * share0);
+	float lambda1 = lambda * (config.type2_intensity + flexible * (1 - share0));
+	modelTier(config, param[0], lambda0, lambda * (config.type1_intensity + flexible), tier[0]);
+	modelTier(config, param[1], lambda1, lambda * (config.type2_intensity + flexible), tier[1]);
+
+	// The controller hands out one request per cycle
+	float rho_ctrl = config.num_cores * config.mem_intensity;
+	float dispatch = (rho_ctrl < 1) ? mdWait(rho_ctrl, 1) : 0;
+
+	float accesses = 0, latency = 0, energy = 0;
+	for(int i=0; i < NUM_TYPES; i++) {
+		accesses += tier[i].accesses;
+		latency += tier[i].accesses * (dispatch + tier[i].wait + tier[i].service);
+		energy += (tier[i].accesses > 0) ? tier[i].energy : 0;
+	}
+
+	// 99th percentile of the mixture
+	float p99 = 0;
+	if(accesses > 0) {
+		float lo = 0, hi = 1e9;
+		for(int iter=0; iter < 100; iter++) {
+			float t = (lo + hi) / 2;
+			float tail = 0;
+			for(int i=0; i < NUM_TYPES; i++) {
+				float wait = t - dispatch - tier[i].service;
+				float p = tier[i].asleep * waitTail(tier[i], wait - tier[i].shift)
+					+ (1 - tier[i].asleep) * waitTail(tier[i], wait);
+				tail += tier[i].accesses / accesses * p;
+			}
+			if(tail > 0.01) lo = t; else hi = t;
+		}
+		p99 = hi;
+	}
+
+	result.total_access = accesses * ctrl.num_ranks;
+	result.migration_access = 0;
+	result.promotions = 0;
+	result.demotions = 0;
+	result.avg_latency = (accesses > 0) ? latency / accesses : 0;
+	result.p99_latency = p99;
+	result.avg_energy = (accesses > 0) ? energy / accesses : 0;
+	result.ed_product = result.avg_latency * result.avg_energy;
+	result.ticked_cycles = 0;
+	result.skipped_cycles = 0;
+	result.core_access.clear();
+	result.core_latency.clear();
+	result.core_bandwidth.clear();
+}
+
+const unsigned int validate_intensity[] = { 2, 5, 10, 20 }; // Per mille
+const SchedPolicy validate_sched[] = { FIFO, BACKLOG, COST };
+const PDPolicy validate_pd[] = { NONE, CONSERVATIVE, WATERMARK };
+
+struct ValidatePoint {
+	SimConfig config;
+	SimResult sim;
+	SimResult model;
+};
+
+static void validatePoint(unsigned int index, void *arg) {
+	vector<ValidatePoint> &points = *(vector<ValidatePoint> *) arg;
+	runSimulation(points[index].config, points[index].sim, false);
+}
+
+static float relError(float model, float sim) {
+	if(sim == 0) return 0;
+	return (model - sim) / sim;
+}
+
+static double elapsedMicroseconds(const struct timespec &start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start.tv_sec) * 1e6 + (now.tv_nsec - start.tv_nsec) / 1e3;
+}
+
+void validateAnalytical(const SimConfig &base, unsigned int num_threads) {
+	vector<ValidatePoint> points;
+	for(int i=0; i < sizeof(validate_intensity)/sizeof(validate_intensity[0]); i++) {
+		for(int s=0; s < sizeof(validate_sched)/sizeof(validate_sched[0]); s++) {
+			for(int p=0; p < sizeof(validate_pd)/sizeof(validate_pd[0]); p++) {
+				ValidatePoint point;
+				point.config = base;
+				point.config.mem_intensity = validate_intensity[i] / 1000.0;
+				point.config.ctrl.sched_policy = validate_sched[s];
+				point.config.ctrl.pd_policy = validate_pd[p];
+				points.push_back(point);
+			}
+		}
+	}
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int i=0; i < points.size(); i++) {
+		estimateAnalytical(points[i].config, points[i].model);
+	}
+	double model_time = elapsedMicroseconds(start);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	parallelFor(points.size(), num_threads, validatePoint, &points);
+	double sim_time = elapsedMicroseconds(start);
+
+	float err_latency = 0, err_p99 = 0, err_energy = 0, err_ed = 0;
+
+	cout << "MPKI Sched Power-Down : Latency sim/model (err) | P99 sim/model (err) | Energy sim/model (err) | E-D err" << endl;
+	cout << fixed << setprecision(1);
+	for(int i=0; i < points.size(); i++) {
+		const ValidatePoint &point = points[i];
+		float e_lat = relError(point.model.avg_latency, point.sim.avg_latency);
+		float e_p99 = relError(point.model.p99_latency, point.sim.p99_latency);
+		float e_energy = relError(point.model.avg_energy, point.sim.avg_energy);
+		float e_ed = relError(point.model.ed_product, point.sim.ed_product);
+
+		cout << setw(4) << point.config.mem_intensity * 1000 << " "
+			<< schedPolicyName(point.config.ctrl.sched_policy) << " "
+			<< pdPolicyName(point.config.ctrl.pd_policy) << " : "
+			<< point.sim.avg_latency << "/" << point.model.avg_latency << " (" << 100 * e_lat << "%) | "
+			<< point.sim.p99_latency << "/" << point.model.p99_latency << " (" << 100 * e_p99 << "%) | "
+			<< point.sim.avg_energy << "/" << point.model.avg_energy << " (" << 100 * e_energy << "%) | "
+			<< 100 * e_ed << "%" << endl;
+
+		err_latency += fabs(e_lat);
+		err_p99 += fabs(e_p99);
+		err_energy += fabs(e_energy);
+		err_ed += fabs(e_ed);
+	}
+
+	unsigned int n = points.size();
+	cout << "Mean Abs Error : Latency " << 100 * err_latency / n << "% P99 " << 100 * err_p99 / n
+		<< "% Energy " << 100 * err_energy / n << "% E-D " << 100 * err_ed / n << "%" << endl;
+	cout << "Model Time : " << model_time << " us, Simulation Time : " << sim_time << " us" << endl;
+	cout.unsetf(ios::fixed);
+}
@@ -0,0 +1,34 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  analytical.h
+ *
+ *    Description:  First-order queueing model of the heterogeneous memory system
+ *
+ *        Version:  1.0
+ *        Created:  06/26/2014 09:48:21 AM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#ifndef _ANALYTICAL_H_
+#define _ANALYTICAL_H_
+
+#include "simulator.h"
+
+// Each rank is an M/D/1 queue of single-burst requests (banks share it
+// round-robin) with the power-down policy modelled as a vacation: a setup
+// time on wake-up for CONSERVATIVE, an N-policy at the watermark for
+// BACKLOG and WATERMARK. Fills the aggregate fields of result over the
+// same measurement window runSimulation() uses.
+void estimateAnalytical(const SimConfig &config, SimResult &result);
+
+// Compare the model with the simulator over an intensity x policy grid and
+// print the per-point and mean absolute errors
+void validateAnalytical(const SimConfig &base, unsigned int num_threads);
+
+#endif
@@ -17,59 +17,269 @@
 
 #include "controller.h"
 #include <cstdlib>
+#include <cctype>
+#include <cstring>
+#include <cmath>
+#include <cassert>
 
-Controller::Controller(unsigned int num_ranks_, unsigned int num_banks_, SchedPolicy sched_policy_, PDPolicy pd_policy_) : num_ranks(num_ranks_) {
-	sched_policy = sched_policy_;
-	pd_policy = pd_policy_;
+const unsigned int LATENCY_BUCKETS = 4*64;
+
+static unsigned int latencyBucket(unsigned long int latency) {
+	unsigned int bucket = 4 * log2(latency + 1.0);
+	return (bucket < LATENCY_BUCKETS) ? bucket : LATENCY_BUCKETS - 1;
+}
+
+const char *refresh_mode_names[] = { "off", "allbank", "perbank" };
+
+void defaultControllerConfig(ControllerConfig &config) {
+	config.num_ranks = 4;
+	config.num_banks = 4;
+	config.queue_depth = QUEUE_DEPTH;
+	config.queue_capacity = QUEUE_CAPACITY;
+	config.sched_policy = FIFO;
+	config.pd_policy = NONE;
+	config.pd_wm = PD_WM;
+	config.timeout = 0;
+	config.sr_timeout = 0;
+	config.refresh = REFRESH_OFF;
+	config.placement_weight = 0.5;
+
+	config.num_pages = 0;
+	config.tier_epoch = 0;
+	config.tier_hot = 8;
+	config.tier_capacity = 1024;
+	config.tier_migrations = 64;
+
+	config.num_cores = 4;
+	config.qos = false;
+	config.qos_burst = 8;
+	config.qos_window = 4;
+	config.qos_depth = QOS_DEPTH;
+}
+
+bool parseRefreshMode(const char *arg, RefreshMode &mode) {
+	for(int i=0; i <= PER_BANK; i++) {
+		if(!strcmp(arg, refresh_mode_names[i]) || (isdigit(arg[0]) && atoi(arg) == i)) {
+			mode = (RefreshMode) i;
+			return true;
+		}
+	}
+	return false;
+}
+
+const char *refreshModeName(RefreshMode mode) {
+	return refresh_mode_names[mode];
+}
+
+Controller::Controller(const ControllerConfig &config) : num_ranks(config.num_ranks), num_banks(config.num_banks) {
+	pd_wm = config.pd_wm;
+	timeout = config.timeout;
+	sr_timeout = config.sr_timeout;
+	placement_weight = config.placement_weight;
 
 	for(int i=0; i < NUM_TYPES; i++) {
 		ranks[i] = new DRAM* [num_ranks];
 		request_counter[i].resize(num_ranks);
+		held_counter[i].resize(num_ranks, 0);
 		power_down_status[i].resize(num_ranks);
 
 		for(int j=0; j<num_ranks; j++) {
-			ranks[i][j] = new DRAM(num_banks_, i);
+			ranks[i][j] = new DRAM(config.num_banks, i, config.queue_depth, config.refresh);
+			ranks[i][j]->setCompletionHandler(onComplete, this);
 			request_counter[i][j] = 0;
 			power_down_status[i][j] = false;
 		}
 	}
 
 	mutual_request_counter.resize(num_ranks);
+	held_mutual_counter.resize(num_ranks, 0);
+
+	tiers = NULL;
+	if(config.num_pages != 0) {
+		tiers = new TierManager(config.num_pages, config.tier_hot, config.tier_capacity, config.tier_migrations);
+	}
+	tier_epoch = config.tier_epoch;
+
+	// Rows are only known through pages
+	batching = (config.num_pages != 0);
+	for(int i=0; i < NUM_TYPES; i++) {
+		last_page[i].resize(num_ranks * num_banks, 0);
+	}
+
+	num_cores = config.num_cores;
+	qos = config.qos;
+	qos_burst = config.qos_burst;
+	qos_window = config.qos_window;
+	qos_depth = config.qos_depth;
+	qos_rate.resize(num_cores, 1);
+	qos_class.resize(num_cores, 0);
+	for(int i=0; i < num_cores; i++) {
+		if(i < config.qos_rate.size()) qos_rate[i] = config.qos_rate[i];
+		if(i < config.qos_class.size()) qos_class[i] = config.qos_class[i];
+	}
+
+	core_queue.resize(num_cores);
+	tokens.resize(num_cores, qos_burst);
+	next_core = 0;
+
+	core_access.resize(num_cores, 0);
+	core_latency.resize(num_cores, 0);
+	latency_histogram.resize(LATENCY_BUCKETS, 0);
+	backpressure = 0;
+
+	queue_capacity = config.queue_capacity;
+	occupancy = 0;
+
+	refresh = config.refresh;
+	refresh_pull_in = (config.pd_policy != NONE);
 
 	clock = 0;
+	owns_requests = true;
+	completion_handler = NULL;
+	completion_arg = NULL;
 }
 
 Controller::~Controller() {
-	while(!request_queue.empty()) {
-		Request *req = request_queue.front();
-		request_queue.pop_front();
-		delete req;
+	vector<Request *> leftover(request_queue.begin(), request_queue.end());
+	for(int i=0; i < num_cores; i++) {
+		leftover.insert(leftover.end(), core_queue[i].begin(), core_queue[i].end());
 	}
 
 	for(int i=0; i < NUM_TYPES; i++) {
 		for(int j=0; j<num_ranks; j++) {
+			ranks[i][j]->flushRequests(leftover);
 			delete ranks[i][j];
 		}
 		delete [] ranks[i];
 	}
+
+	// Migration requests are always ours
+	for(int i=0; i < leftover.size(); i++) {
+		if(owns_requests || leftover[i]->migration) {
+			delete leftover[i];
+		}
+	}
+
+	delete tiers;
 }
 
-void Controller::clockTick() {
+void Controller::beginTick() {
 	for(int i=0; i < NUM_TYPES; i++) {
 		for(int j=0; j<num_ranks; j++) {
 			ranks[i][j]->clockTick();
 		}
 	}
 
-	scheduleRequests();
+	if(refresh != REFRESH_OFF) {
+		scheduleRefresh();
+	}
+
+	if(qos) {
+		admitRequests();
+	}
+}
 
-	schedPowerDown();
+// Refreshes are postponed while a rank has work, up to the JEDEC limit,
+// and done or pulled in while it is idle so that a powered-down rank is
+// woken for refresh as rarely as possible
+void Controller::scheduleRefresh() {
+	for(int i=0; i < NUM_TYPES; i++) {
+		for(int j=0; j < num_ranks; j++) {
+			DRAM *rank = ranks[i][j];
+			int owed = rank->refreshOwed();
+			Status status = rank->getStatus();
+
+			if(status == SELF_REFRESH) {
+				continue;
+			}
+
+			if(status == POWER_DOWN) {
+				if(owed >= REFRESH_POSTPONE) {
+					wake(i, j);
+				}
+				continue;
+			}
+
+			bool idle = rank->isQuiescent() && queuedRequests(i, j) == 0;
+			if(owed >= REFRESH_POSTPONE || (idle && owed > 0) || (idle && refresh_pull_in && owed > -REFRESH_PULL_IN)) {
+				rank->refresh();
+			}
+		}
+	}
+}
+
+void Controller::endTick() {
+	demoteRanks();
 
 	clock++;
+
+	if(tiers != NULL && tier_epoch != 0 && clock % tier_epoch == 0) {
+		migratePages();
+	}
 }
 
-void Controller::addRequest(Request *req) {
+bool Controller::addRequest(Request *req) {
 	// cout << "Adding request : " << *req << endl;
+	// Held back requests are bounded per core, so a throttled core only
+	// ever stalls itself. Admission counts them in later.
+	if(!req->migration) {
+		if(isFull(req->core)) {
+			return false;
+		}
+		if(!qos) {
+			occupancy++;
+		}
+	}
+
+	if(tiers != NULL && req->type != 2 && !req->migration) {
+		req->type = tiers->access(req->page, req->type);
+	}
+
+	// Held back requests do not count towards power-down decisions, so a
+	// throttled core cannot keep ranks awake. They do count towards waking
+	// one (wakeDemand).
+	if(qos && !req->migration) {
+		core_queue[req->core].push_back(req);
+		if(req->type != 2) {
+			held_counter[req->type][req->rank]++;
+		} else {
+			held_mutual_counter[req->rank]++;
+		}
+	} else {
+		enqueueRequest(req);
+	}
+
+	return true;
+}
+
+bool Controller::isFull() {
+	return queue_capacity != 0 && occupancy >= queue_capacity;
+}
+
+bool Controller::isFull(unsigned int core) {
+	if(!qos) {
+		return isFull();
+	}
+	return qos_depth != 0 && core_queue[core].size() >= qos_depth;
+}
+
+bool Controller::isSaturated() {
+	if(!qos) {
+		return isFull();
+	}
+
+	if(!isFull() && request_queue.size() < qos_window) {
+		return false;
+	}
+	for(int i=0; i < num_cores; i++) {
+		if(!isFull(i)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void Controller::enqueueRequest(Request *req) {
 	request_queue.push_back(req);
 
 	if(req->type != 2) {
@@ -79,198 +289,286 @@ void Controller::addRequest(Request *req) {
 	}
 }
 
-void Controller::scheduleRequests() {
-	// FIFO as starting point
-	if(sched_policy == FIFO) {
-		if(!request_queue.empty()) {
-			Request *req = request_queue.front();
-			request_queue.pop_front();
-
-			if(req->type == 2) { 
-				unsigned int type1_backlog = ranks[0][req->rank]->backlog(req->bank);
-				unsigned int type2_backlog = ranks[1][req->rank]->backlog(req->bank);
-
-				if(type1_backlog < type2_backlog) {
-					ranks[0][req->rank]->addRequest(req);
-					if(power_down_status[0][req->rank] == true) {
-						ranks[0][req->rank]->powerUp();
-					}
-				} else {
-					ranks[1][req->rank]->addRequest(req);
-					if(power_down_status[1][req->rank] == true) {
-						ranks[1][req->rank]->powerUp();
-					}
-				}
-				mutual_request_counter[req->rank]--;
-			} else {
-				// cout << "Adding request at clock : " << clock << " to type : " << req->type << " rank : " << req->rank << " req : " << req << endl;
-				ranks[req->type][req->rank]->addRequest(req);
-				request_counter[req->type][req->rank] -= 1;
-				if(power_down_status[req->type][req->rank] == true) {
-					ranks[req->type][req->rank]->powerUp();
-				}
-			}
-		}
-	} else if(sched_policy == PD_AWARE) {
-		if(!request_queue.empty()) {
-			Request *req = request_queue.front();
-			request_queue.pop_front();
+void Controller::setCompletionHandler(CompletionHandler handler, void *arg) {
+	owns_requests = (handler == NULL);
+	completion_handler = handler;
+	completion_arg = arg;
+}
 
-			if(req->type == 2) { 
-				if(power_down_status[0][req->rank] == false && power_down_status[1][req->rank] == true) {
-					ranks[0][req->rank]->addRequest(req);
-				} else if(power_down_status[0][req->rank] == true && power_down_status[1][req->rank] == false) {
-					ranks[1][req->rank]->addRequest(req);
-				}
+void Controller::onComplete(Request *req, void *arg) {
+	((Controller *) arg)->completeRequest(req);
+}
 
-				unsigned int type1_backlog = ranks[0][req->rank]->backlog(req->bank);
-				unsigned int type2_backlog = ranks[1][req->rank]->backlog(req->bank);
+void Controller::completeRequest(Request *req) {
+	if(!req->migration && req->core < num_cores) {
+		core_latency[req->core] = (core_latency[req->core] * core_access[req->core] + req->latency) / float(core_access[req->core] + 1);
+		core_access[req->core]++;
+	}
 
-				if(type1_backlog < type2_backlog) {
-					ranks[0][req->rank]->addRequest(req);
-				} else {
-					ranks[1][req->rank]->addRequest(req);
-				}
-				mutual_request_counter[req->rank]--;
-			} else {
-				// cout << "Adding request at clock : " << clock << " to type : " << req->type << " rank : " << req->rank << " req : " << req << endl;
-				ranks[req->type][req->rank]->addRequest(req);
-				request_counter[req->type][req->rank]--;
-				if(power_down_status[req->type][req->rank] == true) {
-					ranks[req->type][req->rank]->powerUp();
-					// cout << "Clock : " << clock << " powering up type : " << req->type << " rank : " << req->rank << endl;
-				}
+	if(!req->migration) {
+		latency_histogram[latencyBucket(req->latency)]++;
+	} else if(req->type != req->migrate_to) {
+		// The write needs the data the read just returned
+		issueMigration(req->page, req->migrate_to, req->migrate_to);
+	} else {
+		tiers->finishMigration(req->page, req->type);
+	}
+
+	if(req->migration || completion_handler == NULL) {
+		delete req;
+	} else {
+		completion_handler(req, completion_arg);
+	}
+}
+
+// Refill every core's bucket, then hand the scheduler up to qos_window
+// requests, highest class first and round-robin within a class.
+void Controller::admitRequests() {
+	for(int i=0; i < num_cores; i++) {
+		tokens[i] += qos_rate[i];
+		if(tokens[i] > qos_burst) tokens[i] = qos_burst;
+	}
+
+	while(request_queue.size() < qos_window && !isFull()) {
+		int pick = -1;
+		for(int k=0; k < num_cores; k++) {
+			unsigned int c = (next_core + k) % num_cores;
+			if(core_queue[c].empty() || tokens[c] < 1) {
+				continue;
 			}
-		}
-	} else if(sched_policy == BACKLOG) {
-		list<Request *>::iterator it = request_queue.begin();
-		for(; it != request_queue.end(); it++) {
-			Request *req = *it;
-
-			// Check if its blocked too long
-			// If YES schedule it instantly
-			/* if((clock - req->start_time) > TIMEOUT) {
-				if(req->type == 2) { 
-					unsigned int type1_backlog = ranks[0][req->rank]->backlog(req->bank);
-					unsigned int type2_backlog = ranks[1][req->rank]->backlog(req->bank);
-
-					if(type1_backlog < type2_backlog) {
-						ranks[0][req->rank]->addRequest(req);
-						if(power_down_status[0][req->rank] == true) {
-							ranks[0][req->rank]->powerUp();
-						}
-					} else {
-						ranks[1][req->rank]->addRequest(req);
-						if(power_down_status[1][req->rank] == true) {
-							ranks[1][req->rank]->powerUp();
-						}
-					}
-					mutual_request_counter[req->rank]--;
-				} else {
-					// cout << "Adding request at clock : " << clock << " to type : " << req->type << " rank : " << req->rank << " req : " << req << endl;
-					ranks[req->type][req->rank]->addRequest(req);
-					request_counter[req->type][req->rank] -= 1;
-					if(power_down_status[req->type][req->rank] == true) {
-						ranks[req->type][req->rank]->powerUp();
-					}
-				}
-				request_queue.erase(it);
-				break;
-			} */
-
-			if(req->type == 2) { 
-				if(power_down_status[0][req->rank] == false && power_down_status[1][req->rank] == true) {
-					ranks[0][req->rank]->addRequest(req);
-					request_queue.erase(it);
-					mutual_request_counter[req->rank]--;
-					break;
-				} else if(power_down_status[0][req->rank] == true && power_down_status[1][req->rank] == false) {
-					ranks[1][req->rank]->addRequest(req);
-					request_queue.erase(it);
-					mutual_request_counter[req->rank]--;
-					break;
-				} else if(power_down_status[0][req->rank] == false && power_down_status[1][req->rank] == false) {
-					unsigned int type1_backlog = ranks[0][req->rank]->backlog(req->bank);
-					unsigned int type2_backlog = ranks[1][req->rank]->backlog(req->bank);
-
-					if(type1_backlog < type2_backlog) {
-						ranks[0][req->rank]->addRequest(req);
-					} else {
-						ranks[1][req->rank]->addRequest(req);
-					}
-					request_queue.erase(it);
-					mutual_request_counter[req->rank]--;
-					break;
-				} else {
-					// Both power down
-					// Check for watermarks before scheduling
-					if((ranks[0][req->rank]->totalBacklog() + request_counter[0][req->rank] + mutual_request_counter[req->rank]) >= PD_WM) {
-						ranks[0][req->rank]->addRequest(req);
-						ranks[0][req->rank]->powerUp();
-						power_down_status[0][req->rank] = false;
-						request_queue.erase(it);
-						mutual_request_counter[req->rank]--;
-						break;
-					} else if((ranks[1][req->rank]->totalBacklog() + request_counter[1][req->rank] + mutual_request_counter[req->rank]) >= PD_WM) {
-						ranks[1][req->rank]->addRequest(req);
-						ranks[1][req->rank]->powerUp();
-						power_down_status[1][req->rank] = false;
-						request_queue.erase(it);
-						mutual_request_counter[req->rank]--;
-						break;
-					}
-				}
-			} else { // Req is type 1 or 2
-				// cout << "Clock : " << clock << " PD : " << power_down_status[req->type][req->rank] << " Backlog : " << (ranks[req->type][req->rank]->totalBacklog() + request_counter[req->type][req->rank]) << endl;
-				if(power_down_status[req->type][req->rank] == false) {
-					ranks[req->type][req->rank]->addRequest(req);
-					request_counter[req->type][req->rank]--;
-					request_queue.erase(it);
-					break;
-				} else if(power_down_status[req->type][req->rank] == true && (ranks[req->type][req->rank]->totalBacklog() + request_counter[req->type][req->rank]) >= PD_WM) {
-					// cout << "Adding request at clock : " << clock << " to type : " << req->type << " rank : " << req->rank << " req : " << req << endl;
-					ranks[req->type][req->rank]->addRequest(req);
-					request_counter[req->type][req->rank]--;
-					ranks[req->type][req->rank]->powerUp();
-					power_down_status[req->type][req->rank] = false;
-					// cout << "Clock : " << clock << " powering up type : " << req->type << " rank : " << req->rank << endl;
-					request_queue.erase(it);
-					break;
-				}
+			if(pick == -1 || qos_class[c] > qos_class[pick]) {
+				pick = c;
 			}
 		}
+
+		if(pick == -1) {
+			break;
+		}
+
+		Request *req = core_queue[pick].front();
+		core_queue[pick].pop_front();
+		if(req->type != 2) {
+			held_counter[req->type][req->rank]--;
+		} else {
+			held_mutual_counter[req->rank]--;
+		}
+		enqueueRequest(req);
+		occupancy++;
+		tokens[pick] -= 1;
+		next_core = (pick + 1) % num_cores;
+	}
+}
+
+// Each page move is a read on the source type and a write on the
+// destination type, scheduled like any other request
+void Controller::migratePages() {
+	migrations.clear();
+	tiers->rebalance(migrations);
+
+	// Only the reads go out now, each write follows its read's completion
+	for(int i=0; i < migrations.size(); i++) {
+		issueMigration(migrations[i].page, migrations[i].from, migrations[i].to);
+	}
+}
+
+void Controller::issueMigration(unsigned int page, unsigned int type, unsigned int to) {
+	Request *req = new Request;
+	req->id = 0;
+	req->page = page;
+	req->type = type;
+	req->rank = req->page % num_ranks;
+	req->bank = (req->page / num_ranks) % num_banks;
+	req->core = 0;
+	req->bursts = 1;
+	req->start_time = clock;
+	req->migration = true;
+	req->migrate_to = to;
+	req->batched = false;
+
+	addRequest(req);
+}
+
+bool Controller::accepts(Request *req, unsigned int type) {
+	if(ranks[type][req->rank]->isFull(req->bank)) {
+		backpressure++;
+		return false;
+	}
+	return true;
+}
+
+// Queued pick-up of req on the given type, counters follow the request
+void Controller::dispatch(Request *req, unsigned int type) {
+	// Same row as the request ahead of it in a busy bank : no activation
+	unsigned int slot = req->rank * num_banks + req->bank;
+	if(batching) {
+		req->batched = (last_page[type][slot] == req->page && ranks[type][req->rank]->isBankBusy(req->bank));
+		last_page[type][slot] = req->page;
+	}
+
+	// Counters stay keyed on the requested type, the placement is only
+	// reported back
+	req->placed_type = type;
+
+	// Policies only dispatch what accepts() let through
+	bool queued = ranks[type][req->rank]->addRequest(req);
+	assert(queued);
+	(void) queued;
+
+	if(!req->migration) {
+		occupancy--;
+	}
+
+	if(req->type == 2) {
+		mutual_request_counter[req->rank]--;
 	} else {
-		cerr << "Incompatible scheduling policy\n\n";
-		exit(1);
+		request_counter[req->type][req->rank]--;
 	}
 }
 
-void Controller::schedPowerDown() {
-	if(pd_policy == NONE) {
-	} else if(pd_policy == CONSERVATIVE) {
-		for(int i=0; i < NUM_TYPES; i++) {
-			for(int j=0; j < num_ranks; j++) {
-				if(ranks[i][j]->totalBacklog() == 0 && request_counter[i][j] == 0 && mutual_request_counter[j] == 0) {
-					ranks[i][j]->powerDown();
-					// cout << "Clock : " << clock << " powering down type : " << i << " rank : " << j << endl;
-					power_down_status[i][j] = true;
-				}
-			}
+// Issue requests right behind head to the same row in the same cycle, so
+// they stream out back-to-back
+void Controller::dispatchFollowers(Request *head, unsigned int type) {
+	if(!batching) {
+		return;
+	}
+
+	for(int n=0; n < BATCH_LIMIT && !request_queue.empty(); n++) {
+		Request *req = request_queue.front();
+		if(req->migration || req->rank != head->rank || req->bank != head->bank || req->page != head->page) {
+			return;
 		}
-	} else if(pd_policy == WATERMARK) {
-		for(int i=0; i < NUM_TYPES; i++) {
-			for(int j=0; j < num_ranks; j++) {
-				if((ranks[i][j]->totalBacklog() + request_counter[i][j] + mutual_request_counter[j]) < PD_WM) {
-					ranks[i][j]->powerDown();
-					// cout << "Clock : " << clock << " powering down type : " << i << " rank : " << j << endl;
-					power_down_status[i][j] = true;
-				}
+		if(req->type != type && req->type != 2) {
+			return;
+		}
+		if(!accepts(req, type)) {
+			return;
+		}
+
+		request_queue.pop_front();
+		dispatch(req, type);
+	}
+}
+
+void Controller::wake(unsigned int type, unsigned int rank) {
+	ranks[type][rank]->powerUp();
+	power_down_status[type][rank] = false;
+}
+
+void Controller::sleep(unsigned int type, unsigned int rank) {
+	ranks[type][rank]->powerDown();
+
+	// A rank due for refresh stays up
+	Status status = ranks[type][rank]->getStatus();
+	power_down_status[type][rank] = (status == POWER_DOWN || status == SELF_REFRESH);
+}
+
+// Shorter bank queue wins, ties go to type 1
+unsigned int Controller::placeShorter(Request *req) {
+	unsigned int type1_backlog = ranks[0][req->rank]->backlog(req->bank);
+	unsigned int type2_backlog = ranks[1][req->rank]->backlog(req->bank);
+
+	return (type1_backlog < type2_backlog) ? 0 : 1;
+}
+
+// Pick the rank minimizing latency^w * energy^(1-w) for a flexible request.
+// w = 0.5 minimizes the request's own E-D product.
+unsigned int Controller::placeFlexible(Request *req) {
+	unsigned int best_type = 0;
+	float best_cost = 0;
+
+	for(int i=0; i < NUM_TYPES; i++) {
+		float latency = ranks[i][req->rank]->estimateLatency(req->bank);
+		float energy = ranks[i][req->rank]->estimateEnergy();
+		float cost = pow(latency, placement_weight) * pow(energy, 1 - placement_weight);
+
+		// A full queue only wins if both are full
+		if(ranks[i][req->rank]->isFull(req->bank) && !ranks[best_type][req->rank]->isFull(req->bank)) {
+			continue;
+		}
+
+		if(i == 0 || cost < best_cost || ranks[best_type][req->rank]->isFull(req->bank)) {
+			best_type = i;
+			best_cost = cost;
+		}
+	}
+
+	return best_type;
+}
+
+bool Controller::isQuiescent() {
+	if(!request_queue.empty()) {
+		return false;
+	}
+
+	for(int i=0; i < num_cores; i++) {
+		if(!core_queue[i].empty()) {
+			return false;
+		}
+	}
+
+	for(int i=0; i < NUM_TYPES; i++) {
+		for(int j=0; j < num_ranks; j++) {
+			if(!ranks[i][j]->isQuiescent()) {
+				return false;
 			}
 		}
-	} else {
-		cerr << "Incompatible scheduling policy\n\n";
-		exit(1);
+	}
+
+	return true;
+}
 
+// Bulk accounting for a quiescent controller. Power-down decisions have
+// already settled on the tick that drained the last request, what is still
+// time driven (self-refresh demotion, refresh wake-ups) the ranks replay.
+// Tiering epochs are not replayed, with no demand traffic left they would
+// only move idle pages around.
+void Controller::skipCycles(unsigned long int cycles) {
+	for(int i=0; i < NUM_TYPES; i++) {
+		for(int j=0; j < num_ranks; j++) {
+			ranks[i][j]->skipCycles(cycles, refresh_pull_in, sr_timeout);
+
+			Status status = ranks[i][j]->getStatus();
+			power_down_status[i][j] = (status == POWER_DOWN || status == SELF_REFRESH);
+		}
+	}
+
+	clock += cycles;
+}
+
+void Controller::resetStats() {
+	for(int i=0; i < NUM_TYPES; i++) {
+		for(int j=0; j < num_ranks; j++) {
+			ranks[i][j]->resetStats();
+		}
+	}
+
+	for(int i=0; i < num_cores; i++) {
+		core_access[i] = 0;
+		core_latency[i] = 0;
+	}
+	for(int i=0; i < LATENCY_BUCKETS; i++) {
+		latency_histogram[i] = 0;
+	}
+	backpressure = 0;
+
+	// Promotions and demotions, like migration accesses, from here on
+	if(tiers != NULL) {
+		tiers->resetStats();
+	}
+}
+
+// Ranks that stay powered down long enough drop into self-refresh
+void Controller::demoteRanks() {
+	if(sr_timeout == 0) {
+		return;
+	}
+
+	for(int i=0; i < NUM_TYPES; i++) {
+		for(int j=0; j < num_ranks; j++) {
+			if(ranks[i][j]->getStatus() == POWER_DOWN && ranks[i][j]->lowPowerCycles() >= sr_timeout) {
+				ranks[i][j]->selfRefresh();
+			}
+		}
 	}
 }
 
@@ -287,6 +585,26 @@ unsigned int Controller::totalAccess() {
 	return total_access;
 }
 
+unsigned int Controller::totalMigrationAccess() {
+	unsigned int total_access = 0;
+
+	for(int i=0; i < NUM_TYPES; i++) {
+		for(int j=0; j < num_ranks; j++) {
+			total_access += ranks[i][j]->numMigrationAccess();
+		}
+	}
+
+	return total_access;
+}
+
+unsigned long int Controller::numPromotions() {
+	return (tiers != NULL) ? tiers->numPromotions() : 0;
+}
+
+unsigned long int Controller::numDemotions() {
+	return (tiers != NULL) ? tiers->numDemotions() : 0;
+}
+
 float Controller::avgLatency() {
 	float total_latency = 0;
 	unsigned int total_access = 0;
@@ -305,6 +623,93 @@ float Controller::avgLatency() {
 	return average_latency;
 }
 
+unsigned long int Controller::totalBytes() {
+	unsigned long int total_bytes = 0;
+
+	for(int i=0; i < NUM_TYPES; i++) {
+		for(int j=0; j < num_ranks; j++) {
+			total_bytes += ranks[i][j]->numBytes();
+		}
+	}
+
+	return total_bytes;
+}
+
+float Controller::latencyPerByte() {
+	float total_latency = 0;
+	unsigned long int total_bytes = totalBytes();
+
+	for(int i=0; i < NUM_TYPES; i++) {
+		for(int j=0; j < num_ranks; j++) {
+			total_latency += ranks[i][j]->avgLatency() * ranks[i][j]->numAccess();
+		}
+	}
+
+	if(total_bytes == 0) return 0;
+
+	return total_latency / total_bytes;
+}
+
+float Controller::energyPerByte() {
+	float total_energy = 0;
+	unsigned long int total_bytes = totalBytes();
+
+	for(int i=0; i < NUM_TYPES; i++) {
+		for(int j=0; j < num_ranks; j++) {
+			total_energy += ranks[i][j]->totalEnergy();
+		}
+	}
+
+	if(total_bytes == 0) return 0;
+
+	return total_energy / total_bytes;
+}
+
+unsigned int Controller::typeAccess(unsigned int type) {
+	unsigned int total_access = 0;
+
+	for(int j=0; j < num_ranks; j++) {
+		total_access += ranks[type][j]->numAccess();
+	}
+
+	return total_access;
+}
+
+float Controller::typeLatency(unsigned int type) {
+	float total_latency = 0;
+	unsigned int total_access = 0;
+
+	for(int j=0; j < num_ranks; j++) {
+		unsigned int access_count = ranks[type][j]->numAccess();
+		total_access += access_count;
+		total_latency += ranks[type][j]->avgLatency() * access_count;
+	}
+
+	if(total_access == 0) return 0;
+
+	return total_latency / total_access;
+}
+
+// Upper edge of the bucket holding the quantile
+float Controller::latencyPercentile(float quantile) {
+	unsigned long int total = 0;
+	for(int i=0; i < LATENCY_BUCKETS; i++) {
+		total += latency_histogram[i];
+	}
+
+	if(total == 0) return 0;
+
+	unsigned long int seen = 0;
+	for(int i=0; i < LATENCY_BUCKETS; i++) {
+		seen += latency_histogram[i];
+		if(seen >= quantile * total) {
+			return pow(2, (i + 1) / 4.0) - 1;
+		}
+	}
+
+	return pow(2, LATENCY_BUCKETS / 4.0) - 1;
+}
+
 float Controller::avgEnergy() {
 	float total_energy = 0;
 	unsigned int total_access = 0;
@@ -323,3 +728,47 @@ float Controller::avgEnergy() {
 	return average_energy;
 }
 
+unsigned long int Controller::numBackpressure() {
+	return backpressure;
+}
+
+unsigned long int Controller::numRefreshes() {
+	unsigned long int total = 0;
+
+	for(int i=0; i < NUM_TYPES; i++) {
+		for(int j=0; j < num_ranks; j++) {
+			total += ranks[i][j]->numRefreshes();
+		}
+	}
+
+	return total;
+}
+
+unsigned int Controller::numRanks() {
+	return num_ranks;
+}
+
+unsigned int Controller::rankBacklog(unsigned int type, unsigned int rank) {
+	return ranks[type][rank]->totalBacklog();
+}
+
+Status Controller::rankStatus(unsigned int type, unsigned int rank) {
+	return ranks[type][rank]->getStatus();
+}
+
+
+unsigned long int Controller::coreAccess(unsigned int core) {
+	return core_access[core];
+}
+
+float Controller::coreLatency(unsigned int core) {
+	return core_latency[core];
+}
+
+// The caller knows the window the accesses were generated in, the clock
+// also covers the drain
+float Controller::coreBandwidth(unsigned int core, unsigned long int cycles) {
+	if(cycles == 0) return 0;
+
+	return core_access[core] / float(cycles);
+}
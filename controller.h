@@ -23,15 +23,18 @@
 
 #include "request.h"
 #include "dram.h"
+#include "tiering.h"
 
 using namespace std;
 
 const unsigned int NUM_TYPES = 2;
 
+// Built-in policies, numbered in registry order (policy.cpp)
 enum SchedPolicy {
 	FIFO=0,
 	PD_AWARE,
-	BACKLOG
+	BACKLOG,
+	COST // FIFO order, flexible requests placed by the cost model
 };
 
 enum PDPolicy {
@@ -40,9 +43,76 @@ enum PDPolicy {
 	WATERMARK
 };
 
-const unsigned int PD_WM = 10; // Watermark for power-down
-const unsigned int TIMEOUT = 1000;
+const unsigned int PD_WM = 10; // Default watermark for power-down
+const unsigned int QUEUE_DEPTH = 256; // Default bank queue capacity
+const unsigned int QUEUE_CAPACITY = 256; // Default controller queue capacity
+const unsigned int QOS_DEPTH = 64; // Default requests held back per core
+const unsigned int BATCH_LIMIT = 8; // Same-row requests issued behind one another in a cycle
 
+struct ControllerConfig {
+	unsigned int num_ranks;
+	unsigned int num_banks;
+	unsigned int queue_depth;  // Requests per bank queue, rounded up to a power of two
+	unsigned int queue_capacity; // Admitted requests the controller holds before refusing more (0 : unbounded)
+	SchedPolicy sched_policy;
+	PDPolicy pd_policy;
+	unsigned int pd_wm;        // Watermark for power-down
+	unsigned long int timeout; // BACKLOG schedules anything older than this (0 : never)
+	unsigned long int sr_timeout; // Power-down cycles before demoting to self-refresh (0 : never)
+	RefreshMode refresh;
+	float placement_weight; // COST : 1 weighs only latency, 0 only energy
+
+	// Tiering
+	unsigned int num_pages;          // 0 : requests carry no page, no tiering
+	unsigned long int tier_epoch;    // Cycles between migration rounds (0 : static first-touch placement)
+	unsigned int tier_hot;           // Decayed access count that makes a page hot
+	unsigned int tier_capacity;      // Pages type 0 can hold
+	unsigned int tier_migrations;    // Page moves per epoch
+
+	// Per-core QoS
+	unsigned int num_cores;
+	bool qos;                    // Admit requests through per-core token buckets
+	vector<float> qos_rate;      // Tokens per cycle per core (missing : 1)
+	vector<unsigned int> qos_class; // Higher class is admitted first (missing : 0)
+	float qos_burst;             // Bucket depth in tokens
+	unsigned int qos_window;     // Admitted requests the scheduler may see at once
+	unsigned int qos_depth;      // Requests held back per core before it is refused (0 : unbounded)
+};
+
+void defaultControllerConfig(ControllerConfig &config);
+
+// Accept either the policy number or its registered name, return false if
+// neither (policy.cpp)
+bool parseSchedPolicy(const char *arg, SchedPolicy &policy);
+bool parsePDPolicy(const char *arg, PDPolicy &policy);
+const char *schedPolicyName(SchedPolicy policy);
+const char *pdPolicyName(PDPolicy policy);
+unsigned int numSchedPolicies();
+unsigned int numPDPolicies();
+
+// Whether the pair reads pd_wm / timeout at all, from the policies'
+// usesWatermark() / usesTimeout() traits
+bool usesWatermark(const ControllerConfig &config);
+bool usesTimeout(const ControllerConfig &config);
+
+// False if a scheduler reading the watermark (BACKLOG) could never see
+// the watermark's worth of requests queued for one rank, within the queue
+// capacity or the QoS window and per-core depths
+bool reachesWatermark(const ControllerConfig &config);
+
+// "off", "allbank", "perbank" or the mode number
+bool parseRefreshMode(const char *arg, RefreshMode &mode);
+const char *refreshModeName(RefreshMode mode);
+
+class Controller;
+
+// Controller specialized for the configured policy pair, NULL if either
+// is not registered or the watermark is out of reach
+Controller *createController(const ControllerConfig &config);
+
+// Policy-independent part of the controller. The per-cycle policy calls
+// live in PolicyController<Sched, PD> (policy.h), built by
+// createController().
 class Controller {
 private:
 	list<Request *> request_queue; // list for traversal
@@ -50,28 +120,150 @@ private:
 
 	vector<unsigned int> request_counter[NUM_TYPES];
 	vector<unsigned int> mutual_request_counter;
+	vector<unsigned int> held_counter[NUM_TYPES]; // Held back by QoS, not yet admitted
+	vector<unsigned int> held_mutual_counter;
 	vector<bool> power_down_status[NUM_TYPES];
 
-	unsigned int clock;
+	unsigned long int clock;
+	bool owns_requests; // False once an external completion handler is installed
+	CompletionHandler completion_handler;
+	void *completion_arg;
+
+	TierManager *tiers;
+	vector<Migration> migrations;
+
+	// Row batching, last page dispatched per type and rank * num_banks + bank
+	bool batching;
+	vector<unsigned int> last_page[NUM_TYPES];
+
+	// QoS admission ahead of request_queue
+	vector< list<Request *> > core_queue;
+	vector<float> tokens;
+	unsigned int next_core; // Round-robin within a class
+
+	// Per-core stats
+	vector<unsigned long int> core_access;
+	vector<float> core_latency;
+
+	// Demand latency in quarter-octave buckets
+	vector<unsigned long int> latency_histogram;
+
+	unsigned long int backpressure; // Dispatches refused by a full bank queue
+
+	unsigned int queue_capacity;
+	unsigned int occupancy; // Demand requests admitted and not yet dispatched, held back ones excluded
+
+	RefreshMode refresh;
+	bool refresh_pull_in; // Refresh ahead on idle ranks that will be powered down
 
 	// Config
 	unsigned int num_ranks;
-	SchedPolicy sched_policy;
-	PDPolicy pd_policy;
+	unsigned int num_banks;
+	unsigned int pd_wm;
+	unsigned long int timeout;
+	unsigned long int sr_timeout;
+	float placement_weight;
+	unsigned long int tier_epoch;
+	unsigned int num_cores;
+	bool qos;
+	vector<float> qos_rate;
+	vector<unsigned int> qos_class;
+	float qos_burst;
+	unsigned int qos_window;
+	unsigned int qos_depth;
+
+	static void onComplete(Request *req, void *arg);
+	void completeRequest(Request *req);
+	void migratePages();
+	void issueMigration(unsigned int page, unsigned int type, unsigned int to);
+	void admitRequests();
+	void enqueueRequest(Request *req);
+	void scheduleRefresh();
+
+protected:
+	// Everything around the policies in a cycle
+	void beginTick();
+	void endTick();
 
 public:
-	Controller(unsigned int num_ranks_, unsigned int num_banks_, SchedPolicy sched_policy_, PDPolicy pd_policy_);
-	~Controller();
+	Controller(const ControllerConfig &config);
+	virtual ~Controller();
+
+	virtual void clockTick() = 0;
+
+	// False, and the request is not taken, while the controller is full, or
+	// with QoS while the issuing core holds back qos_depth requests.
+	// Migration requests are always taken.
+	bool addRequest(Request *req);
+	bool isFull(); // Admitted requests at the queue capacity
+	bool isFull(unsigned int core); // addRequest() would refuse the core
+	// Nothing more can reach the scheduler until something is dispatched
+	bool isSaturated();
+	void setCompletionHandler(CompletionHandler handler, void *arg);
+	void demoteRanks();
 
-	void clockTick();
+	// Used by the policies
+	list<Request *> &pendingRequests() { return request_queue; }
+	DRAM *rankOf(unsigned int type, unsigned int rank) { return ranks[type][rank]; }
+	bool isPoweredDown(unsigned int type, unsigned int rank) { return power_down_status[type][rank]; }
+	// Queued at the controller for the rank, flexible requests included
+	unsigned int queuedRequests(unsigned int type, unsigned int rank) {
+		return request_counter[type][rank] + mutual_request_counter[rank];
+	}
+	// Backlog the watermark is compared to
+	unsigned int demand(unsigned int type, unsigned int rank) {
+		return ranks[type][rank]->totalBacklog() + request_counter[type][rank] + mutual_request_counter[rank];
+	}
+	unsigned int typeDemand(unsigned int type, unsigned int rank) {
+		return ranks[type][rank]->totalBacklog() + request_counter[type][rank];
+	}
+	// Backlog a powered-down rank is woken at, requests QoS still holds
+	// back included : admission only shows the scheduler qos_window of them
+	unsigned int wakeDemand(unsigned int type, unsigned int rank) {
+		return demand(type, rank) + held_counter[type][rank] + held_mutual_counter[rank];
+	}
+	unsigned int typeWakeDemand(unsigned int type, unsigned int rank) {
+		return typeDemand(type, rank) + held_counter[type][rank];
+	}
+	unsigned long int cycle() { return clock; }
+	unsigned int watermark() { return pd_wm; }
+	unsigned long int schedTimeout() { return timeout; }
 
-	void addRequest(Request *req);
-	void scheduleRequests();
-	void schedPowerDown();
+	// False if the bank queue of req on type is full, counted as back-pressure
+	bool accepts(Request *req, unsigned int type);
+	void dispatch(Request *req, unsigned int type);
+	void dispatchFollowers(Request *head, unsigned int type);
+	void wake(unsigned int type, unsigned int rank);
+	void sleep(unsigned int type, unsigned int rank);
+	unsigned int placeShorter(Request *req);
+	unsigned int placeFlexible(Request *req);
+
+	bool isQuiescent();
+	void skipCycles(unsigned long int cycles);
+	void resetStats();
 
 	unsigned int totalAccess();
+	unsigned int totalMigrationAccess();
+	unsigned long int numPromotions();
+	unsigned long int numDemotions();
 	float avgLatency();
+	float latencyPercentile(float quantile); // Within ~20%
+	unsigned long int totalBytes();
+	float latencyPerByte(); // Demand latency summed over requests, per byte moved
+	float energyPerByte();  // All energy, per demand byte
+	unsigned int typeAccess(unsigned int type);
+	float typeLatency(unsigned int type);
 	float avgEnergy();
+	unsigned long int numBackpressure();
+	unsigned long int numRefreshes();
+
+	unsigned int numRanks();
+	unsigned int rankBacklog(unsigned int type, unsigned int rank);
+	Status rankStatus(unsigned int type, unsigned int rank);
+
+	unsigned long int coreAccess(unsigned int core);
+	float coreLatency(unsigned int core);
+	float coreBandwidth(unsigned int core, unsigned long int cycles); // Accesses per cycle over a window of the given length
 };
 
 #endif
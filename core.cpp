@@ -17,13 +17,15 @@
  */
 
 #include <cstdlib>
-#include <time.h>
+#include <cmath>
 
 #include "core.h"
 
-Core::Core(Controller *controller_, float mem_intensity_, float type1_intensity_, float type2_intensity_,
-		unsigned int num_ranks_, unsigned int num_banks_) {
+Core::Core(Controller *controller_, unsigned int core_id_, float mem_intensity_, float type1_intensity_, float type2_intensity_,
+		unsigned int num_ranks_, unsigned int num_banks_, unsigned int num_pages_, float page_skew_,
+		unsigned int max_bursts_, unsigned int seed_) {
 	controller = controller_;
+	core_id = core_id_;
 	mem_intensity = mem_intensity_;
 	type1_intensity = type1_intensity_;
 	type2_intensity = type2_intensity_;
@@ -31,24 +33,52 @@ Core::Core(Controller *controller_, float mem_intensity_, float type1_intensity_
 
 	num_ranks = num_ranks_;
 	num_banks = num_banks_;
+	num_pages = num_pages_;
+	page_skew = page_skew_;
+	max_bursts = max_bursts_;
 
 	clock = 0;
-	srand(time(NULL));
+	seed = seed_;
+
+	pending = NULL;
+	num_access = 0;
+	num_rejected = 0;
+	num_stall_cycles = 0;
 }
 
 Core::~Core() {
+	delete pending;
 }
 
 void Core::clockTick() {
-	float prob = rand() / float(RAND_MAX);
+	// An in-order core issues nothing new while it is stalled
+	if(pending != NULL) {
+		drainTick();
+		return;
+	}
+
+	float prob = rand_r(&seed) / float(RAND_MAX);
 	if(prob < mem_intensity) {
 		Request *req = new Request;
+		req->id = 0;
+		req->core = core_id;
 		req->start_time = clock;
+		req->migration = false;
+		req->batched = false;
 
-		req->rank = rand() % num_ranks;
-		req->bank = rand() % num_banks;
+		if(num_pages == 0) {
+			req->page = 0;
+			req->rank = rand_r(&seed) % num_ranks;
+			req->bank = rand_r(&seed) % num_banks;
+		} else {
+			// Pages interleave across ranks, then banks
+			float page_prob = rand_r(&seed) / (float(RAND_MAX) + 1);
+			req->page = (unsigned int) (num_pages * pow(page_prob, page_skew));
+			req->rank = req->page % num_ranks;
+			req->bank = (req->page / num_ranks) % num_banks;
+		}
 
-		float type_prob = rand() / float(RAND_MAX);
+		float type_prob = rand_r(&seed) / float(RAND_MAX);
 		if(type_prob < type1_intensity) {
 			req->type = 0;
 		} else if(type_prob < (type1_intensity + type2_intensity)) {
@@ -57,9 +87,62 @@ void Core::clockTick() {
 			req->type = 2;
 		}
 
-		controller->addRequest(req);
+		// Single bursts draw nothing, so the stream is as before
+		req->bursts = 1;
+		if(max_bursts > 1) {
+			req->bursts = 1 + rand_r(&seed) % max_bursts;
+		}
+
+		issue(req);
+		if(pending != NULL) {
+			num_rejected++;
+			num_stall_cycles++;
+		}
 	}
 
 	clock++;
 }
 
+void Core::drainTick() {
+	if(pending != NULL) {
+		Request *req = pending;
+		req->start_time = clock;
+		issue(req);
+
+		if(pending != NULL) {
+			num_stall_cycles++;
+		}
+	}
+
+	clock++;
+}
+
+// Latency counts from acceptance, the wait before it shows up as stall
+// cycles
+void Core::issue(Request *req) {
+	if(controller->addRequest(req)) {
+		pending = NULL;
+		num_access++;
+	} else {
+		pending = req;
+	}
+}
+
+bool Core::isStalled() {
+	return pending != NULL;
+}
+
+void Core::resetStats() {
+	num_access = 0;
+	num_rejected = 0;
+	num_stall_cycles = 0;
+}
+
+unsigned long int Core::numRejected() {
+	return num_rejected;
+}
+
+unsigned long int Core::stallCycles() {
+	return num_stall_cycles;
+}
+
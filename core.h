@@ -26,6 +26,7 @@ class Core {
 private:
 	Controller *controller;
 	unsigned long int clock;
+	unsigned int core_id;
 
 	// Config
 	float mem_intensity;
@@ -35,16 +36,34 @@ private:
 
 	unsigned int num_ranks;
 	unsigned int num_banks;
+	unsigned int num_pages; // 0 : pick rank and bank directly
+	float page_skew;        // > 1 concentrates accesses on low pages
+	unsigned int max_bursts; // Request size, uniform in 1..max_bursts bursts
+
+	unsigned int seed; // Private rand_r() state
+
+	Request *pending; // Refused by a full controller, the core stalls on it
 
 	// Stats
 	unsigned int num_access;
+	unsigned long int num_rejected;     // Requests refused at least once
+	unsigned long int num_stall_cycles; // Cycles spent holding a refused request
+
+	void issue(Request *req);
 
 public:
-	Core(Controller *controller_, float mem_intensity_, float type1_intensity_, float type2_intensity_,
-			unsigned int num_ranks_, unsigned int num_banks_);
+	Core(Controller *controller_, unsigned int core_id_, float mem_intensity_, float type1_intensity_, float type2_intensity_,
+			unsigned int num_ranks_, unsigned int num_banks_, unsigned int num_pages_, float page_skew_,
+			unsigned int max_bursts_, unsigned int seed_);
 	~Core();
 
 	void clockTick();
+	void drainTick(); // Retry a refused request, generate nothing new
+
+	bool isStalled();
+	void resetStats();
+	unsigned long int numRejected();
+	unsigned long int stallCycles();
 };
 
 #endif
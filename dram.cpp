@@ -16,23 +16,11 @@
  * =====================================================================================
  */
 
-#include "dram.h"
-
-DRAM::DRAM(unsigned int num_banks_, unsigned int type) {
-	status = IDLE;
+#include <algorithm>
 
-	num_banks = num_banks_;
-
-	command_queue.resize(num_banks);
-	now_serving.resize(num_banks);
-
-	req_timer.resize(num_banks);
-	for(int i=0; i<num_banks; i++) {
-		req_timer[i] = 0;
-		now_serving[i] = NULL;
-	}
-	power_up_timer = 0;
+#include "dram.h"
 
+void technologyParameters(unsigned int type, Parameters &param) {
 	if(type == 0) {
 		// Assign GDDR5 parameters
 		param.latency = 20;
@@ -40,6 +28,13 @@ DRAM::DRAM(unsigned int num_banks_, unsigned int type) {
 		param.static_power = 620;
 		param.power_down_power = 280;
 		param.power_up_latency = 400;
+		param.self_refresh_power = 120;
+		param.self_refresh_latency = 1000;
+		param.burst_time = 2;
+		param.burst_power = 300;
+		param.refresh_interval = 3900;
+		param.refresh_latency = 110;
+		param.refresh_power = 1900;
 
 		// Assign RLDRAM3 parameters
 		// param.latency = 16.5;
@@ -47,6 +42,13 @@ DRAM::DRAM(unsigned int num_banks_, unsigned int type) {
 		// param.static_power = 725;
 		// param.power_down_power = 125;
 		// param.power_up_latency = 200;
+		// param.self_refresh_power = 125;
+		// param.self_refresh_latency = 200;
+		// param.burst_time = 2;
+		// param.burst_power = 250;
+		// param.refresh_interval = 3900;
+		// param.refresh_latency = 110;
+		// param.refresh_power = 1400;
 	} else if(type == 1) {
 		// Assign DDR3 parameters
 		param.latency = 47;
@@ -54,6 +56,13 @@ DRAM::DRAM(unsigned int num_banks_, unsigned int type) {
 		param.static_power = 45;
 		param.power_down_power = 40;
 		param.power_up_latency = 600;
+		param.self_refresh_power = 16;
+		param.self_refresh_latency = 1200;
+		param.burst_time = 4;
+		param.burst_power = 50;
+		param.refresh_interval = 7800;
+		param.refresh_latency = 260;
+		param.refresh_power = 150;
 
 		// Assign LPDDR2 parameters
 		// param.latency = 60;
@@ -61,18 +70,79 @@ DRAM::DRAM(unsigned int num_banks_, unsigned int type) {
 		// param.static_power = 1.2;
 		// param.power_down_power = 0.5;
 		// param.power_up_latency = 760;
+		// param.self_refresh_power = 0.2;
+		// param.self_refresh_latency = 900;
+		// param.burst_time = 4;
+		// param.burst_power = 1;
+		// param.refresh_interval = 3900;
+		// param.refresh_latency = 130;
+		// param.refresh_power = 20;
 	}
+}
+
+DRAM::DRAM(unsigned int num_banks_, unsigned int type, unsigned int queue_depth, RefreshMode refresh) {
+	status = IDLE;
+
+	num_banks = num_banks_;
+
+	command_queue.resize(num_banks, RingQueue<Request*>(queue_depth));
+	total_backlog = 0;
+	now_serving.resize(num_banks);
+
+	req_timer.resize(num_banks);
+	for(int i=0; i<num_banks; i++) {
+		req_timer[i] = 0;
+		now_serving[i] = NULL;
+	}
+	power_up_timer = 0;
+	low_power_cycles = 0;
+
+	technologyParameters(type, param);
+
+	// A per-bank refresh covers 1/num_banks of the rows in roughly half the
+	// time of an all-bank one (LPDDR3 tRFCpb/tRFCab)
+	refresh_mode = refresh;
+	refresh_period = param.refresh_interval;
+	refresh_duration = param.refresh_latency;
+	refresh_cost = param.refresh_power * param.refresh_latency;
+	if(refresh_mode == PER_BANK) {
+		refresh_period = param.refresh_interval / num_banks;
+		refresh_duration = param.refresh_latency / 2;
+		refresh_cost /= num_banks;
+	}
+	if(refresh_period == 0) refresh_period = 1;
+	refresh_timer = refresh_period;
+	refresh_owed = 0;
+	refresh_bank = 0;
+	refresh_busy.resize(num_banks, 0);
 
 	next_bank = 0;
+	clock = 0;
+
+	completion_handler = NULL;
+	completion_arg = NULL;
 
 	// Init stats
 	num_access = 0;
+	num_migration_access = 0;
+	num_bytes = 0;
+	num_activations = 0;
+	num_bursts = 0;
 	average_latency = 0;
 	num_idle_cycles = 0;
+	num_active_cycles = 0;
 	num_power_down_cycles = 0;
+	num_self_refresh_cycles = 0;
+	num_refreshes = 0;
+	refresh_energy = 0;
 }
 
 DRAM::~DRAM() {
+	// Requests belong to whoever installed the completion handler
+	if(completion_handler != NULL) {
+		return;
+	}
+
 	for(int i=0; i < num_banks; i++) {
 		while(!command_queue[i].empty()) {
 			Request *req = command_queue[i].front();
@@ -83,9 +153,22 @@ DRAM::~DRAM() {
 }
 
 void DRAM::clockTick() {
+	if(refresh_mode != REFRESH_OFF) {
+		accrueRefresh();
+		for(int i=0; i < num_banks; i++) {
+			if(refresh_busy[i] != 0) refresh_busy[i]--;
+		}
+	}
+
 	if(status == POWER_DOWN) {
 		clock++;
 		num_power_down_cycles++;
+		low_power_cycles++;
+		return;
+	} else if(status == SELF_REFRESH) {
+		clock++;
+		num_self_refresh_cycles++;
+		low_power_cycles++;
 		return;
 	} else if(status == IDLE) {
 		num_idle_cycles++;
@@ -96,15 +179,25 @@ void DRAM::clockTick() {
 			clock++;
 			return;
 		}
+	} else {
+		num_active_cycles++;
 	}
 
 	// Check for serving
 	if(req_timer[next_bank] == 0) {
-		if(!command_queue[next_bank].empty()) {
+		if(!command_queue[next_bank].empty() && !refreshBlocks(next_bank)) {
 			now_serving[next_bank] = command_queue[next_bank].front();
 			command_queue[next_bank].pop();
-
-			req_timer[next_bank] = param.latency;
+			total_backlog--;
+
+			// Further bursts stream out of the open row, a batched request
+			// finds its row already open
+			Request *req = now_serving[next_bank];
+			if(req->batched) {
+				req_timer[next_bank] = req->bursts * param.burst_time;
+			} else {
+				req_timer[next_bank] = param.latency + (req->bursts - 1) * param.burst_time;
+			}
 			status = ACTIVE;
 		}
 	} else {
@@ -114,36 +207,334 @@ void DRAM::clockTick() {
 			now_serving[next_bank]->latency = now_serving[next_bank]->end_time - now_serving[next_bank]->start_time;
 			// cout << "Request ptr : " << now_serving[next_bank] << " served : " << *now_serving[next_bank] << " End : " << clock << endl;
 
-			average_latency = (average_latency * num_access + now_serving[next_bank]->latency) / float(num_access + 1);
-			num_access++;
-
-			delete now_serving[next_bank];
+			Request *req = now_serving[next_bank];
+			if(req->batched) {
+				num_bursts += req->bursts;
+			} else {
+				num_activations++;
+				num_bursts += req->bursts - 1;
+			}
+
+			if(req->migration) {
+				num_migration_access++;
+			} else {
+				average_latency = (average_latency * num_access + req->latency) / float(num_access + 1);
+				num_access++;
+				num_bytes += req->bursts * BURST_BYTES;
+			}
+
+			if(completion_handler != NULL) {
+				completion_handler(now_serving[next_bank], completion_arg);
+			} else {
+				delete now_serving[next_bank];
+			}
 			now_serving[next_bank] = NULL;
 			status = IDLE;
 		}
 	}
 
-	// Round-robin
+	// Round-robin over banks with queued or in-service requests
 	unsigned int prev_bank = next_bank;
 	do {
 		next_bank = (next_bank + 1) % num_banks;
-	} while(prev_bank != next_bank && command_queue[next_bank].empty());
+	} while(prev_bank != next_bank && command_queue[next_bank].empty() && now_serving[next_bank] == NULL);
 
 	clock++;
 }
 
-void DRAM::addRequest(Request *req) {
+// Self-refresh refreshes internally, anything else runs up a debt
+void DRAM::accrueRefresh() {
+	if(status == SELF_REFRESH) {
+		return;
+	}
+
+	refresh_timer--;
+	if(refresh_timer == 0) {
+		refresh_owed++;
+		refresh_timer = refresh_period;
+	}
+}
+
+// Banks refreshing, or waiting to drain for an overdue refresh
+bool DRAM::refreshBlocks(unsigned int bank) {
+	if(refresh_busy[bank] != 0) {
+		return true;
+	}
+
+	return refresh_owed >= REFRESH_POSTPONE && (refresh_mode == ALL_BANK || bank == refresh_bank);
+}
+
+bool DRAM::refresh() {
+	if(refresh_mode == REFRESH_OFF || status == POWER_DOWN || status == SELF_REFRESH || power_up_timer != 0) {
+		return false;
+	}
+
+	if(refresh_mode == ALL_BANK) {
+		for(int i=0; i < num_banks; i++) {
+			if(now_serving[i] != NULL || refresh_busy[i] != 0) {
+				return false;
+			}
+		}
+		for(int i=0; i < num_banks; i++) {
+			refresh_busy[i] = refresh_duration;
+		}
+	} else {
+		if(now_serving[refresh_bank] != NULL || refresh_busy[refresh_bank] != 0) {
+			return false;
+		}
+		refresh_busy[refresh_bank] = refresh_duration;
+		refresh_bank = (refresh_bank + 1) % num_banks;
+	}
+
+	refresh_owed--;
+	num_refreshes++;
+	refresh_energy += refresh_cost;
+	return true;
+}
+
+int DRAM::refreshOwed() {
+	return refresh_owed;
+}
+
+bool DRAM::isRefreshing() {
+	for(int i=0; i < num_banks; i++) {
+		if(refresh_busy[i] != 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool DRAM::addRequest(Request *req) {
 	// cout << "Adding request : " << *req << endl;
-	command_queue[req->bank].push(req);
+	if(!command_queue[req->bank].push(req)) {
+		return false;
+	}
+
+	total_backlog++;
+	return true;
+}
+
+void DRAM::setCompletionHandler(CompletionHandler handler, void *arg) {
+	completion_handler = handler;
+	completion_arg = arg;
+}
+
+void DRAM::flushRequests(vector<Request *> &out) {
+	for(int i=0; i < num_banks; i++) {
+		while(!command_queue[i].empty()) {
+			out.push_back(command_queue[i].front());
+			command_queue[i].pop();
+		}
+
+		if(now_serving[i] != NULL) {
+			out.push_back(now_serving[i]);
+			now_serving[i] = NULL;
+		}
+		req_timer[i] = 0;
+	}
+	total_backlog = 0;
 }
 
 void DRAM::powerDown() {
+	// Already deeper
+	if(status == POWER_DOWN || status == SELF_REFRESH) {
+		return;
+	}
+
+	// Refresh needs the rank up
+	if(isRefreshing() || (refresh_mode != REFRESH_OFF && refresh_owed >= REFRESH_POSTPONE)) {
+		return;
+	}
+
 	status = POWER_DOWN;
+	low_power_cycles = 0;
+}
+
+void DRAM::selfRefresh() {
+	status = SELF_REFRESH;
+	low_power_cycles = 0;
+
+	// The device settles the debt itself
+	if(refresh_owed > 0) refresh_owed = 0;
 }
 
 void DRAM::powerUp() {
+	if(status == SELF_REFRESH) {
+		power_up_timer = param.self_refresh_latency;
+		refresh_timer = refresh_period;
+	} else {
+		power_up_timer = param.power_up_latency;
+	}
 	status = IDLE;
-	power_up_timer = param.power_up_latency;
+}
+
+Status DRAM::getStatus() {
+	return status;
+}
+
+unsigned long int DRAM::lowPowerCycles() {
+	return low_power_cycles;
+}
+
+bool DRAM::isQuiescent() {
+	for(int i=0; i < num_banks; i++) {
+		if(!command_queue[i].empty() || now_serving[i] != NULL || refresh_busy[i] != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Equivalent to ticking a quiescent rank for the given number of cycles,
+// one state change at a time. The controller's refresh decisions are
+// replayed a batch at a time: an awake rank settles each refresh as it
+// falls due; a sleeping one stays down until REFRESH_POSTPONE are owed,
+// then wakes, settles them and pulls in REFRESH_PULL_IN more back to back,
+// and powers down again. sleeps : the power-down policy puts idle ranks
+// down, which is also when refreshes are pulled in.
+void DRAM::skipCycles(unsigned long int cycles, bool sleeps, unsigned long int sr_timeout) {
+	int floor = sleeps ? -REFRESH_PULL_IN : 0;
+	unsigned int side_by_side = (refresh_mode == PER_BANK) ? num_banks : 1;
+
+	while(cycles != 0) {
+		unsigned long int step = cycles;
+		unsigned int settled = 0;
+
+		if(status == POWER_DOWN) {
+			if(sr_timeout != 0) {
+				step = min(step, (low_power_cycles < sr_timeout) ? sr_timeout - low_power_cycles : 0);
+			}
+			if(refresh_mode != REFRESH_OFF) {
+				unsigned long int overdue = 0;
+				if(refresh_owed < REFRESH_POSTPONE) {
+					overdue = refresh_timer + (REFRESH_POSTPONE - 1 - refresh_owed) * refresh_period;
+				}
+				step = min(step, overdue);
+			}
+		} else if(status == IDLE && refresh_mode != REFRESH_OFF) {
+			if(power_up_timer != 0) {
+				step = min(step, power_up_timer);
+			} else if(refresh_owed > floor) {
+				// Overdue refreshes are forced side by side (a bank each for
+				// PER_BANK), the rest wait for an idle rank, one at a time
+				unsigned int owed = refresh_owed - floor;
+				unsigned int side = 1;
+				if(refresh_owed >= REFRESH_POSTPONE) {
+					owed = refresh_owed - (REFRESH_POSTPONE - 1);
+					side = side_by_side;
+				}
+				step = min(step, ((owed + side - 1) / side) * refresh_duration);
+				settled = min((unsigned long int) owed, (step / refresh_duration) * side);
+			} else if(sleeps) {
+				powerDown();
+				continue;
+			} else {
+				step = min(step, refresh_timer);
+			}
+		}
+
+		elapse(step);
+		cycles -= step;
+
+		if(settled != 0) {
+			refresh_owed -= settled;
+			num_refreshes += settled;
+			refresh_energy += settled * refresh_cost;
+			if(refresh_mode == PER_BANK) {
+				refresh_bank = (refresh_bank + settled) % num_banks;
+			}
+		}
+
+		if(status == POWER_DOWN) {
+			if(sr_timeout != 0 && low_power_cycles >= sr_timeout) {
+				selfRefresh();
+			} else if(refresh_mode != REFRESH_OFF && refresh_owed >= REFRESH_POSTPONE) {
+				powerUp();
+			}
+		}
+	}
+}
+
+// Stay in the current state, refresh debt still accrues
+void DRAM::elapse(unsigned long int cycles) {
+	if(refresh_mode != REFRESH_OFF && status != SELF_REFRESH) {
+		if(cycles < refresh_timer) {
+			refresh_timer -= cycles;
+		} else {
+			refresh_owed += 1 + (cycles - refresh_timer) / refresh_period;
+			refresh_timer = refresh_period - (cycles - refresh_timer) % refresh_period;
+		}
+	}
+
+	if(status == POWER_DOWN) {
+		num_power_down_cycles += cycles;
+		low_power_cycles += cycles;
+	} else if(status == SELF_REFRESH) {
+		num_self_refresh_cycles += cycles;
+		low_power_cycles += cycles;
+	} else if(status == IDLE) {
+		num_idle_cycles += cycles;
+
+		if(power_up_timer > cycles) {
+			power_up_timer -= cycles;
+		} else {
+			power_up_timer = 0;
+		}
+	} else {
+		num_active_cycles += cycles;
+	}
+
+	clock += cycles;
+}
+
+void DRAM::resetStats() {
+	num_access = 0;
+	num_migration_access = 0;
+	num_bytes = 0;
+	num_activations = 0;
+	num_bursts = 0;
+	average_latency = 0;
+	num_idle_cycles = 0;
+	num_active_cycles = 0;
+	num_power_down_cycles = 0;
+	num_self_refresh_cycles = 0;
+	num_refreshes = 0;
+	refresh_energy = 0;
+}
+
+// Banks share the rank round-robin, so a new request waits behind all
+// outstanding work in the rank plus any wake-up still to come
+unsigned long int DRAM::estimateLatency(unsigned int bank) {
+	unsigned long int wake = 0;
+	if(status == POWER_DOWN) {
+		wake = param.power_up_latency;
+	} else if(status == SELF_REFRESH) {
+		wake = param.self_refresh_latency;
+	} else {
+		wake = power_up_timer;
+	}
+
+	unsigned long int in_service = 0;
+	for(int i=0; i < num_banks; i++) {
+		in_service += req_timer[i];
+	}
+	in_service += refresh_busy[bank];
+
+	return wake + in_service + (totalBacklog() + 1) * (param.latency + 1);
+}
+
+// Access energy plus the static energy burnt waking the rank up
+float DRAM::estimateEnergy() {
+	float energy = param.dynamic_power;
+
+	if(status == POWER_DOWN) {
+		energy += param.static_power * param.power_up_latency;
+	} else if(status == SELF_REFRESH) {
+		energy += param.static_power * param.self_refresh_latency;
+	}
+
+	return energy;
 }
 
 unsigned int DRAM::backlog(unsigned int bank) {
@@ -151,17 +542,49 @@ unsigned int DRAM::backlog(unsigned int bank) {
 }
 
 unsigned int DRAM::totalBacklog() {
-	unsigned int total_backlog = 0;
-	for(int i=0; i < num_banks; i++) {
-		total_backlog += command_queue[i].size();
-	}
 	return total_backlog;
 }
 
+bool DRAM::isFull(unsigned int bank) {
+	return command_queue[bank].full();
+}
+
+bool DRAM::isBankBusy(unsigned int bank) {
+	return !command_queue[bank].empty() || now_serving[bank] != NULL;
+}
+
 unsigned int DRAM::numAccess() {
 	return num_access;
 }
 
+unsigned int DRAM::numMigrationAccess() {
+	return num_migration_access;
+}
+
+unsigned long int DRAM::numRefreshes() {
+	return num_refreshes;
+}
+
+unsigned long int DRAM::numBytes() {
+	return num_bytes;
+}
+
+unsigned long int DRAM::idleCycles() {
+	return num_idle_cycles;
+}
+
+unsigned long int DRAM::activeCycles() {
+	return num_active_cycles;
+}
+
+unsigned long int DRAM::powerDownCycles() {
+	return num_power_down_cycles;
+}
+
+unsigned long int DRAM::selfRefreshCycles() {
+	return num_self_refresh_cycles;
+}
+
 float DRAM::avgLatency() {
 	if(num_access == 0) {
 		return 0;
@@ -175,13 +598,24 @@ float DRAM::avgEnergy() {
 		return 0;
 	}
 
-	float total_dynamic_energy = param.dynamic_power * num_access;
-	float total_idle_energy = param.static_power * num_idle_cycles;
-	float total_pd_energy = param.power_down_power * num_power_down_cycles;
-
-	float total_energy = total_dynamic_energy + total_idle_energy + total_pd_energy;
-	float average_energy = total_energy / num_access;
+	// Migration traffic is charged to the demand accesses it serves
+	float average_energy = totalEnergy() / num_access;
 
 	return average_energy;
 }
 
+float DRAM::totalEnergy() {
+	EnergyBreakdown energy;
+	energyBreakdown(energy);
+
+	return energy.dynamic + energy.idle + energy.power_down + energy.self_refresh + energy.refresh;
+}
+
+void DRAM::energyBreakdown(EnergyBreakdown &energy) {
+	energy.dynamic = param.dynamic_power * num_activations + param.burst_power * num_bursts;
+	energy.idle = param.static_power * num_idle_cycles;
+	energy.power_down = param.power_down_power * num_power_down_cycles;
+	energy.self_refresh = param.self_refresh_power * num_self_refresh_cycles;
+	energy.refresh = refresh_energy;
+}
+
@@ -19,64 +19,158 @@
 #ifndef _DRAM_H_
 #define _DRAM_H_
 
-#include <queue>
 #include <vector>
 
 #include "request.h"
+#include "ringqueue.h"
 
 using namespace std;
 
 enum Status {
 	IDLE=0,
 	ACTIVE,
-	POWER_DOWN
+	POWER_DOWN,  // Shallow, fast exit
+	SELF_REFRESH // Deep, slow exit
 };
 
+enum RefreshMode {
+	REFRESH_OFF=0,
+	ALL_BANK, // Whole rank blocked for refresh_latency every refresh_interval
+	PER_BANK  // One bank at a time, num_banks times as often and shorter
+};
+
+// JEDEC lets up to 8 refreshes be postponed or pulled in
+const int REFRESH_POSTPONE = 8;
+const int REFRESH_PULL_IN = 8;
+
+// Invoked when a request finishes service. When no handler is installed the
+// DRAM owns its requests and frees them itself.
+typedef void (*CompletionHandler)(Request *req, void *arg);
+
 struct Parameters {
 	unsigned long int latency;
 	unsigned long int power_up_latency;
 	float dynamic_power;
 	float static_power;
 	float power_down_power;
+	unsigned long int self_refresh_latency; // Exit latency out of self-refresh
+	float self_refresh_power;
+	unsigned long int burst_time; // Cycles per further burst within an open row
+	float burst_power;            // Energy of a burst without the activation
+	unsigned long int refresh_interval; // tREFI
+	unsigned long int refresh_latency;  // tRFC of an all-bank refresh
+	float refresh_power;                // On top of static power while refreshing
 };
 
+// Energy since the last stats reset, by component
+struct EnergyBreakdown {
+	float dynamic; // Activations and bursts of demand and migration accesses
+	float idle;    // Static power while up and not serving
+	float power_down;
+	float self_refresh;
+	float refresh;
+};
+
+// Timing and power of memory type 0 (GDDR5) and type 1 (DDR3)
+void technologyParameters(unsigned int type, Parameters &param);
+
 class DRAM {
 private:
-	vector< queue<Request*> > command_queue; // Command Q per bank
+	vector< RingQueue<Request*> > command_queue; // Command Q per bank
+	unsigned int total_backlog; // Queued over all banks
 	Status status;
 
 	vector< Request * > now_serving;
 	vector<unsigned long int> req_timer;
 	unsigned long int power_up_timer;
+	unsigned long int low_power_cycles; // Residency in the current low-power state
 
 	int next_bank; // Round-robin for banks
 	unsigned long int clock;
 
+	// Refresh
+	RefreshMode refresh_mode;
+	unsigned long int refresh_period;   // Between refreshes of this rank's mode
+	unsigned long int refresh_duration; // Of one refresh
+	float refresh_cost;                 // Energy of one refresh
+	unsigned long int refresh_timer; // Cycles until the next refresh falls due
+	int refresh_owed;                // Negative once pulled in
+	unsigned int refresh_bank;       // Next bank for PER_BANK
+	vector<unsigned long int> refresh_busy; // Cycles left refreshing, per bank
+
+	CompletionHandler completion_handler;
+	void *completion_arg;
+
 	// Config
 	unsigned int num_banks;
 	Parameters param;
 
 	// Stats
 	unsigned int num_access;
+	unsigned int num_migration_access;
+	unsigned long int num_bytes;       // Demand
+	unsigned long int num_activations; // Accesses that opened a row
+	unsigned long int num_bursts;      // Bursts beyond the one paid with the activation
 	float average_latency;
 	unsigned long int num_idle_cycles;
+	unsigned long int num_active_cycles;
 	unsigned long int num_power_down_cycles;
+	unsigned long int num_self_refresh_cycles;
+	unsigned long int num_refreshes;
+	float refresh_energy;
+
+	void accrueRefresh();
+	void elapse(unsigned long int cycles);
+	bool refreshBlocks(unsigned int bank);
 
 public:
-	DRAM(unsigned int num_banks_, unsigned int type);
+	DRAM(unsigned int num_banks_, unsigned int type, unsigned int queue_depth, RefreshMode refresh);
 	~DRAM();
 
 	void clockTick();
 
-	void addRequest(Request *req);
-	void powerDown();
+	bool addRequest(Request *req); // False, and not taken, if the bank queue is full
+	void setCompletionHandler(CompletionHandler handler, void *arg);
+	void flushRequests(vector<Request *> &out); // Hand back everything queued or in service
+	void powerDown(); // Refused while a refresh is running or overdue
+	void selfRefresh();
 	void powerUp();
 
+	// Start one refresh (the next bank for PER_BANK), false if the rank is
+	// asleep, waking or the banks concerned are busy
+	bool refresh();
+	int refreshOwed();
+	bool isRefreshing();
+
+	Status getStatus();
+	unsigned long int lowPowerCycles();
+
+	// Nothing queued, in service or refreshing, so further ticks only
+	// accrue idle or power-down cycles (and refresh debt)
+	bool isQuiescent();
+	void skipCycles(unsigned long int cycles, bool sleeps, unsigned long int sr_timeout);
+	void resetStats();
+
+	// Cost model for placing a new request on this rank
+	unsigned long int estimateLatency(unsigned int bank);
+	float estimateEnergy();
+
 	unsigned int backlog(unsigned int bank);
 	unsigned int totalBacklog();
+	bool isFull(unsigned int bank);
+	bool isBankBusy(unsigned int bank); // Queued or in service
 	unsigned int numAccess();
+	unsigned int numMigrationAccess();
+	unsigned long int numRefreshes();
+	unsigned long int numBytes();
+	float totalEnergy();
+	unsigned long int idleCycles();
+	unsigned long int activeCycles();
+	unsigned long int powerDownCycles();
+	unsigned long int selfRefreshCycles();
 	float avgLatency();
 	float avgEnergy();
+	void energyBreakdown(EnergyBreakdown &energy);
 };
 
 #endif
@@ -19,8 +19,15 @@
 #include <iostream>
 #include <cstdlib>
 #include <cstring>
+#include <cstdio>
+#include <time.h>
 #include "controller.h"
-#include "core.h"
+#include "simulator.h"
+#include "tuner.h"
+#include "replicas.h"
+#include "parallel.h"
+#include "analytical.h"
+#include "results.h"
 
 using namespace std;
 
@@ -29,14 +36,48 @@ void print_help() {
 		<< endl
 		<< "** Options:" << endl
 		<< "\t-t <Simulation time> (Default : 10000)" << endl
+		<< "\t--warmup <Warmup cycles, stats reset afterwards> (Default : 0)" << endl
+		<< "\t--measure <Measured cycles, same as -t> (Default : 10000)" << endl
 		<< "\t-r <Ranks> (Default : 4)" << endl
 		<< "\t-b <Banks> (Default : 4)" << endl
+		<< "\t--queue-depth <Requests per bank queue, power of two> (Default : 256)" << endl
+		<< "\t--queue-capacity <Admitted requests the controller holds, 0 is unbounded> (Default : 256)" << endl
 		<< "\t-c <Cores> (Default : 4)" << endl
 		<< "\t-x <Memory Intensity (MPKI)> (Default : 50)" << endl
 		<< "\t-y <Type1 %> (Default : 50)" << endl
 		<< "\t-z <Type2 %> (Default : 50)" << endl
-		<< "\t-s <Sched Policy> (Default : 0)" << endl
-		<< "\t-p <Power-Down Policy> (Default : 0)" << endl
+		<< "\t-s <Sched Policy : 0/fifo, 1/pd_aware, 2/backlog, 3/cost> (Default : 0)" << endl
+		<< "\t-p <Power-Down Policy : 0/none, 1/conservative, 2/watermark> (Default : 0)" << endl
+		<< "\t-w <Power-Down Watermark> (Default : 10)" << endl
+		<< "\t-o <Backlog scheduling timeout, 0 is off> (Default : 0)" << endl
+		<< "\t-d <Power-down cycles before self-refresh, 0 is off> (Default : 0)" << endl
+		<< "\t--refresh <Refresh : 0/off, 1/allbank, 2/perbank> (Default : 0)" << endl
+		<< "\t--placement-weight <Cost policy latency weight, 0..1> (Default : 0.5)" << endl
+		<< "\t--pages <Pages, enables page-based placement> (Default : 0)" << endl
+		<< "\t\tFlexible requests (-z) are placed per request and never tiered" << endl
+		<< "\t--page-skew <Access skew exponent over pages> (Default : 1)" << endl
+		<< "\t--bursts <Maximum bursts per request, sizes uniform from 1> (Default : 1)" << endl
+		<< "\t--tier-epoch <Cycles between page migrations, 0 is off> (Default : 0)" << endl
+		<< "\t--tier-hot <Decayed accesses that make a page hot> (Default : 8)" << endl
+		<< "\t--tier-capacity <Pages held by the fast type> (Default : 1024)" << endl
+		<< "\t--tier-migrations <Page moves per epoch> (Default : 64)" << endl
+		<< "\t--qos : Admit requests through per-core token buckets" << endl
+		<< "\t--qos-rate <Core>:<Tokens per cycle> (Default : 1)" << endl
+		<< "\t--qos-class <Core>:<Priority class, higher first> (Default : 0)" << endl
+		<< "\t--qos-burst <Bucket depth> (Default : 8)" << endl
+		<< "\t--qos-window <Admitted requests visible to the scheduler> (Default : 4)" << endl
+		<< "\t--qos-depth <Requests held back per core, 0 is unbounded> (Default : 64)" << endl
+		<< "\t--seed <Random seed, 0 is wall clock> (Default : 0)" << endl
+		<< "\t--tune : Search watermark/timeout for the best E-D product" << endl
+		<< "\t--tune-time <Cycles per candidate in the first round> (Default : 2000)" << endl
+		<< "\t--analytical : Queueing-model estimate instead of simulation" << endl
+		<< "\t--validate : Compare the queueing model with simulation over a grid" << endl
+		<< "\t--replicas <Runs with different seeds, reports mean +- 95% CI> (Default : 1)" << endl
+		<< "\t--threads <Parallel simulations> (Default : online CPUs)" << endl
+		<< "\t--json <File, - for stdout> : Write config and full results as JSON" << endl
+		<< "\t--csv <File, - for stdout> : Append config and full results as a CSV row" << endl
+		<< "\t--shm <Shared-memory name for live stats, see hdramstat> (Default : off)" << endl
+		<< "\t--shm-interval <Cycles between live stats updates> (Default : 10000)" << endl
 		<< "\t-h or --help : Help screen" << endl
 		<< endl
 		;
@@ -51,17 +92,23 @@ void sim_need_argument(int argc, char **argv, int argi)
 }
 
 int main(int argc, char *argv[]) {
-	cout << "\t\tHDRAM Simulator" << endl << endl;
+	SimConfig config;
+	defaultSimConfig(config);
 
-	unsigned long int sim_time = 10000;
-	unsigned int num_ranks=4, num_banks=4, num_cores=4;
-	float mem_intensity=0.05, type1_intensity=0.5, type2_intensity=0.5;
-	SchedPolicy sched_policy = FIFO;
-	PDPolicy pd_policy = NONE;
+	bool tune_mode = false;
+	TuneConfig tune;
+	defaultTuneConfig(tune);
+
+	bool analytical_mode = false, validate_mode = false;
+	unsigned int num_replicas = 1;
+	const char *results_path = NULL;
+	ResultFormat results_format = JSON;
+	unsigned int num_threads = defaultThreads();
 
 	// Command line parsing
 	for(int argi=1; argi < argc; argi++) {
 		if(!strcmp(argv[argi], "-h") || !strcmp(argv[argi], "--help")) {
+			cout << "\t\tHDRAM Simulator" << endl << endl;
 			print_help();
 			return 1;
 		}
@@ -69,119 +116,459 @@ int main(int argc, char *argv[]) {
 		if(!strcmp(argv[argi], "-t")) {
 			sim_need_argument(argc, argv, argi);
 			argi++;
-			sim_time = atoi(argv[argi]);
+			config.sim_time = atoi(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--warmup")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.warmup_time = atoi(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--measure")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.sim_time = atoi(argv[argi]);
 			continue;
 		}
 
 		if(!strcmp(argv[argi], "-r")) {
 			sim_need_argument(argc, argv, argi);
 			argi++;
-			num_ranks = atoi(argv[argi]);
+			config.ctrl.num_ranks = atoi(argv[argi]);
 			continue;
 		}
 
 		if(!strcmp(argv[argi], "-b")) {
 			sim_need_argument(argc, argv, argi);
 			argi++;
-			num_banks = atoi(argv[argi]);
+			config.ctrl.num_banks = atoi(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--queue-capacity")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.ctrl.queue_capacity = atoi(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--queue-depth")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.ctrl.queue_depth = atoi(argv[argi]);
 			continue;
 		}
 
 		if(!strcmp(argv[argi], "-c")) {
 			sim_need_argument(argc, argv, argi);
 			argi++;
-			num_cores = atoi(argv[argi]);
+			config.num_cores = atoi(argv[argi]);
 			continue;
 		}
 
 		if(!strcmp(argv[argi], "-x")) {
 			sim_need_argument(argc, argv, argi);
 			argi++;
-			mem_intensity = atoi(argv[argi])/1000.0;
+			config.mem_intensity = atoi(argv[argi])/1000.0;
 			continue;
 		}
 
 		if(!strcmp(argv[argi], "-y")) {
 			sim_need_argument(argc, argv, argi);
 			argi++;
-			type1_intensity = atoi(argv[argi])/100.0;
+			config.type1_intensity = atoi(argv[argi])/100.0;
 			continue;
 		}
 
 		if(!strcmp(argv[argi], "-z")) {
 			sim_need_argument(argc, argv, argi);
 			argi++;
-			type2_intensity = atoi(argv[argi])/100.0;
+			config.type2_intensity = atoi(argv[argi])/100.0;
 			continue;
 		}
 
 		if(!strcmp(argv[argi], "-s")) {
 			sim_need_argument(argc, argv, argi);
 			argi++;
-			sched_policy = (SchedPolicy) atoi(argv[argi]);
+			if(!parseSchedPolicy(argv[argi], config.ctrl.sched_policy)) {
+				cerr << "Unknown scheduling policy '" << argv[argi] << "'\n\n";
+				return 1;
+			}
 			continue;
 		}
 
 		if(!strcmp(argv[argi], "-p")) {
 			sim_need_argument(argc, argv, argi);
 			argi++;
-			pd_policy = (PDPolicy) atoi(argv[argi]);
+			if(!parsePDPolicy(argv[argi], config.ctrl.pd_policy)) {
+				cerr << "Unknown power-down policy '" << argv[argi] << "'\n\n";
+				return 1;
+			}
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "-w")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.ctrl.pd_wm = atoi(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "-o")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.ctrl.timeout = atoi(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "-d")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.ctrl.sr_timeout = atoi(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--refresh")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			if(!parseRefreshMode(argv[argi], config.ctrl.refresh)) {
+				cerr << "Unknown refresh mode '" << argv[argi] << "'\n\n";
+				return 1;
+			}
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--placement-weight")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.ctrl.placement_weight = atof(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--pages")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.ctrl.num_pages = atoi(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--page-skew")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.page_skew = atof(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--bursts")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.max_bursts = atoi(argv[argi]);
+			if(config.max_bursts == 0 || config.max_bursts > MAX_BURSTS) {
+				cerr << "Bursts must be 1 to " << MAX_BURSTS << "\n\n";
+				exit(1);
+			}
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--tier-epoch")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.ctrl.tier_epoch = atoi(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--tier-hot")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.ctrl.tier_hot = atoi(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--tier-capacity")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.ctrl.tier_capacity = atoi(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--tier-migrations")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.ctrl.tier_migrations = atoi(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--qos")) {
+			config.ctrl.qos = true;
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--qos-rate") || !strcmp(argv[argi], "--qos-class")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			unsigned int core;
+			float value;
+			if(sscanf(argv[argi], "%u:%f", &core, &value) != 2) {
+				cerr << "Option '" << argv[argi-1] << "' expects <core>:<value>\n\n";
+				return 1;
+			}
+
+			if(!strcmp(argv[argi-1], "--qos-rate")) {
+				if(config.ctrl.qos_rate.size() <= core) config.ctrl.qos_rate.resize(core + 1, 1);
+				config.ctrl.qos_rate[core] = value;
+			} else {
+				if(config.ctrl.qos_class.size() <= core) config.ctrl.qos_class.resize(core + 1, 0);
+				config.ctrl.qos_class[core] = (unsigned int) value;
+			}
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--qos-burst")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.ctrl.qos_burst = atof(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--qos-window")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.ctrl.qos_window = atoi(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--qos-depth")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.ctrl.qos_depth = atoi(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--seed")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.seed = atoi(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--tune")) {
+			tune_mode = true;
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--tune-time")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			tune.base_time = atoi(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--threads")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			num_threads = atoi(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--analytical")) {
+			analytical_mode = true;
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--validate")) {
+			validate_mode = true;
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--json") || !strcmp(argv[argi], "--csv")) {
+			sim_need_argument(argc, argv, argi);
+			results_format = !strcmp(argv[argi], "--json") ? JSON : CSV;
+			argi++;
+			results_path = argv[argi];
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--shm")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.shm_name = argv[argi];
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--shm-interval")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			config.shm_interval = atoi(argv[argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "--replicas")) {
+			sim_need_argument(argc, argv, argi);
+			argi++;
+			num_replicas = atoi(argv[argi]);
 			continue;
 		}
 
         /*  Invalid option */
 		if (argv[argi][0] == '-') {
-			cout << "'" << argv[argi] << "' is not a valid command-line option.\n"
+			cerr << "'" << argv[argi] << "' is not a valid command-line option.\n"
 				<< "Please type './hdram --help' for help screen\n\n";
 		}
 	}
 
-	// Simulator initialization
-	Controller *controller = new Controller(num_ranks, num_banks, sched_policy, pd_policy);
+	// Results written to stdout keep it to themselves, the human-readable
+	// output goes to stderr
+	bool results_stdout = (results_path != NULL && !strcmp(results_path, "-"));
+	ostream &out = results_stdout ? cerr : cout;
+	out << "\t\tHDRAM Simulator" << endl << endl;
 
-	Core **cores = new Core *[num_cores];
-	for(int i=0; i < num_cores; i++) {
-		cores[i] = new Core(controller, mem_intensity, type1_intensity, type2_intensity,
-				num_cores, num_banks);
+	// Concurrent runs would all publish into the same segment
+	if(config.shm_name != NULL && (tune_mode || analytical_mode || validate_mode || num_replicas > 1)) {
+		cerr << "--shm only applies to a single simulation\n\n";
+		return 1;
 	}
 
-	// Simulation Loop
-	for(unsigned long int cycle=0; cycle < sim_time; cycle++) {
-		for(int i=0; i < num_cores; i++) {
-			cores[i]->clockTick();
-		}
+	// Only simulations have results to write
+	if(results_path != NULL && (tune_mode || analytical_mode || validate_mode)) {
+		cerr << "--json / --csv only apply to simulations and --replicas\n\n";
+		return 1;
+	}
 
-		controller->clockTick();
+	// The queueing model serves every request in one burst
+	if(config.max_bursts > 1 && (analytical_mode || validate_mode)) {
+		cerr << "--analytical / --validate model single-burst requests only, drop --bursts\n\n";
+		return 1;
+	}
 
-		// Heartbeat
-		if(cycle % (sim_time / 10) == 0) {
-			cout << "cycle : " << cycle << endl;
-		}
+	// The simulator hands the core count to the controller
+	config.ctrl.num_cores = config.num_cores;
+	if(!tune_mode && !reachesWatermark(config.ctrl)) {
+		cerr << "Watermark " << config.ctrl.pd_wm << " is more than the controller can hold"
+			<< " (--queue-capacity, --qos-window, --qos-depth), backlog would never wake a rank\n\n";
+		return 1;
+	}
+
+	if(tune_mode && !usesWatermark(config.ctrl) && !usesTimeout(config.ctrl)) {
+		cerr << "--tune : " << schedPolicyName(config.ctrl.sched_policy) << " / "
+			<< pdPolicyName(config.ctrl.pd_policy) << " reads neither the watermark nor the timeout\n\n";
+		return 1;
+	}
+
+	if(tune_mode) {
+		tune.threads = num_threads;
+
+		TuneCandidate best;
+		tunePolicy(config, tune, best, true);
+
+		cout << "Sched Policy : " << schedPolicyName(config.ctrl.sched_policy) << endl;
+		cout << "Power-Down Policy : " << pdPolicyName(config.ctrl.pd_policy) << endl;
+		cout << "Best Watermark : " << best.pd_wm << endl;
+		cout << "Best Timeout : " << best.timeout << endl;
+		cout << "E-D Product : " << best.result.ed_product << endl;
+		return 0;
 	}
 
-	for(unsigned long int cycle=sim_time; cycle < 3*sim_time; cycle++) {
-		controller->clockTick();
+	if(analytical_mode) {
+		struct timespec start, end;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+
+		SimResult estimate;
+		estimateAnalytical(config, estimate);
+
+		clock_gettime(CLOCK_MONOTONIC, &end);
+
+		cout << "Total Access : " << estimate.total_access << endl;
+		cout << "Average Latency : " << estimate.avg_latency << endl;
+		cout << "99th Percentile Latency : " << estimate.p99_latency << endl;
+		cout << "Average Energy : " << estimate.avg_energy << endl;
+		cout << "E-D Product : " << estimate.ed_product << endl;
+		cout << "Estimate Time : " << (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3 << " us" << endl;
+		return 0;
+	}
+
+	if(validate_mode) {
+		validateAnalytical(config, num_threads);
+		return 0;
+	}
+
+	if(num_replicas > 1) {
+		ReplicaResult replicas;
+		runReplicas(config, num_replicas, num_threads, replicas);
+
+		out << "Replicas : " << num_replicas << endl;
+		out << "Total Access : " << replicas.total_access.mean << " +- " << replicas.total_access.ci << endl;
+		out << "Average Latency : " << replicas.avg_latency.mean << " +- " << replicas.avg_latency.ci << endl;
+		out << "99th Percentile Latency : " << replicas.p99_latency.mean << " +- " << replicas.p99_latency.ci << endl;
+		out << "Average Energy : " << replicas.avg_energy.mean << " +- " << replicas.avg_energy.ci << endl;
+		out << "E-D Product : " << replicas.ed_product.mean << " +- " << replicas.ed_product.ci << endl;
+		out << "Back-Pressure : " << replicas.backpressure.mean << " +- " << replicas.backpressure.ci << endl;
+		out << "Stall Cycles : " << replicas.stall_cycles.mean << " +- " << replicas.stall_cycles.ci << endl;
+		out << "Rejected Issues : " << replicas.rejected.mean << " +- " << replicas.rejected.ci << endl;
+		out << "Total Bytes : " << replicas.total_bytes.mean << " +- " << replicas.total_bytes.ci << endl;
+		out << "Latency Per Byte : " << replicas.latency_per_byte.mean << " +- " << replicas.latency_per_byte.ci << endl;
+		out << "Energy Per Byte : " << replicas.energy_per_byte.mean << " +- " << replicas.energy_per_byte.ci << endl;
+		if(config.ctrl.refresh != REFRESH_OFF) {
+			out << "Refreshes : " << replicas.refreshes.mean << " +- " << replicas.refreshes.ci << endl;
+		}
+		if(config.ctrl.tier_epoch != 0) {
+			out << "Migration Access : " << replicas.migration_access.mean << " +- " << replicas.migration_access.ci << endl;
+			out << "Promotions : " << replicas.promotions.mean << " +- " << replicas.promotions.ci << endl;
+			out << "Demotions : " << replicas.demotions.mean << " +- " << replicas.demotions.ci << endl;
+		}
 
-		// Heartbeat
-		if(cycle % (sim_time/10) == 0) {
-			cout << "cycle : " << cycle << endl;
+		if(results_path != NULL && !writeReplicaResults(results_path, results_format, config, replicas)) {
+			cerr << "Cannot write results to " << results_path << "\n\n";
+			return 1;
 		}
+		return 0;
+	}
+
+	SimResult result;
+	if(!runSimulation(config, result, !results_stdout)) {
+		cerr << "Incompatible scheduling policy\n\n";
+		return 1;
+	}
+
+	out << "Total Access : " << result.total_access << endl;
+	out << "Average Latency : " << result.avg_latency << endl;
+	out << "99th Percentile Latency : " << result.p99_latency << endl;
+	out << "Average Energy : " << result.avg_energy << endl;
+	out << "E-D Product : " << result.ed_product << endl;
+	out << "Back-Pressure : " << result.backpressure << endl;
+	out << "Stall Cycles : " << result.stall_cycles << endl;
+	out << "Rejected Issues : " << result.rejected << endl;
+	out << "Total Bytes : " << result.total_bytes << endl;
+	out << "Latency Per Byte : " << result.latency_per_byte << endl;
+	out << "Energy Per Byte : " << result.energy_per_byte << endl;
+	if(config.ctrl.refresh != REFRESH_OFF) {
+		out << "Refreshes : " << result.refreshes << endl;
 	}
 
-	unsigned int total_access = controller->totalAccess();
-	float avg_latency = controller->avgLatency();
-	float avg_energy = controller->avgEnergy();
-	cout << "Total Access : " << total_access << endl;
-	cout << "Average Latency : " << avg_latency << endl;
-	cout << "Average Energy : " << avg_energy << endl;
-	cout << "E-D Product : " << (avg_latency * avg_energy) << endl;
+	for(int i=0; i < NUM_TYPES; i++) {
+		out << "Type " << i << " : Access " << result.type_access[i]
+			<< " Latency " << result.type_latency[i] << endl;
+	}
+
+	for(int i=0; i < config.num_cores; i++) {
+		out << "Core " << i << " : Access " << result.core_access[i]
+			<< " Latency " << result.core_latency[i]
+			<< " Bandwidth " << result.core_bandwidth[i]
+			<< " Stall " << result.core_stall[i] << endl;
+	}
+
+	if(config.ctrl.tier_epoch != 0) {
+		out << "Migration Access : " << result.migration_access << endl;
+		out << "Promotions : " << result.promotions << endl;
+		out << "Demotions : " << result.demotions << endl;
+	}
 
-	// Free heap
-	for(int i=0; i < num_cores; i++) {
-		delete cores[i];
+	if(results_path != NULL && !writeResults(results_path, results_format, config, result)) {
+		cerr << "Cannot write results to " << results_path << "\n\n";
+		return 1;
 	}
-	delete [] cores;
-	delete controller;
 
 	return 0;
 }
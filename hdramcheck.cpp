@@ -0,0 +1,240 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  hdramcheck.cpp
+ *
+ *    Description:  Regression checks of the simulator (make check)
+ *
+ *        Version:  1.0
+ *        Created:  07/06/2014 10:14:32 AM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#include <iostream>
+
+#include "controller.h"
+#include "libhdram.h"
+
+using namespace std;
+
+static unsigned int failures = 0;
+
+static void check(bool ok, const char *what) {
+	cout << (ok ? "PASS : " : "FAIL : ") << what << endl;
+	if(!ok) failures++;
+}
+
+// Bulk skipping with refresh on must replay refresh, but not tiering
+// epochs: promotions and demotions stay where the drain left them.
+static void checkSkipWithRefreshAndTiering() {
+	ControllerConfig config;
+	defaultControllerConfig(config);
+	config.pd_policy = CONSERVATIVE;
+	config.refresh = ALL_BANK;
+	config.num_pages = 64;
+	config.tier_epoch = 5000;
+
+	Controller *controller = createController(config);
+
+	// Fast pages hot enough to outlive the drain, demoted once enough
+	// epochs have decayed their counts
+	for(int i=0; i < 256; i++) {
+		Request *req = new Request;
+		req->id = 0;
+		req->type = 0;
+		req->page = i % 16;
+		req->rank = req->page % config.num_ranks;
+		req->bank = (req->page / config.num_ranks) % config.num_banks;
+		req->core = 0;
+		req->bursts = 1;
+		req->start_time = 0;
+		req->migration = false;
+		req->batched = false;
+		controller->addRequest(req);
+	}
+
+	while(!controller->isQuiescent()) {
+		controller->clockTick();
+	}
+	check(controller->cycle() < config.tier_epoch, "drained within the first epoch");
+
+	unsigned long int promotions = controller->numPromotions();
+	unsigned long int demotions = controller->numDemotions();
+	unsigned long int refreshes = controller->numRefreshes();
+	unsigned long int cycle = controller->cycle();
+
+	controller->skipCycles(100 * config.tier_epoch);
+
+	check(controller->cycle() == cycle + 100 * config.tier_epoch, "skip advances the clock");
+	check(controller->numPromotions() == promotions, "no promotions while skipping");
+	check(controller->numDemotions() == demotions, "no demotions while skipping");
+	check(controller->numRefreshes() > refreshes, "refreshes replayed while skipping");
+	check(controller->isQuiescent(), "still quiescent after the skip");
+
+	delete controller;
+}
+
+// BACKLOG with more ranks than the queue capacity spread over them : the
+// controller fills up before any powered-down rank reaches the watermark
+// and must still wake one.
+static void checkBacklogWithFullController() {
+	ControllerConfig config;
+	defaultControllerConfig(config);
+	config.num_ranks = 32;
+	config.queue_capacity = 16;
+	config.sched_policy = BACKLOG;
+	config.pd_policy = CONSERVATIVE;
+
+	Controller *controller = createController(config);
+
+	// Every rank goes down on the first idle tick
+	controller->clockTick();
+
+	unsigned int added = 0;
+	for(int i=0; ; i++) {
+		Request *req = new Request;
+		req->id = 0;
+		req->type = 0;
+		req->rank = i % config.num_ranks;
+		req->bank = 0;
+		req->page = 0;
+		req->core = 0;
+		req->bursts = 1;
+		req->start_time = controller->cycle();
+		req->migration = false;
+		req->batched = false;
+		if(!controller->addRequest(req)) {
+			delete req;
+			break;
+		}
+		added++;
+	}
+	check(added == config.queue_capacity && controller->isFull(), "controller full below the watermark");
+
+	for(int i=0; i < 10000 && !controller->isQuiescent(); i++) {
+		controller->clockTick();
+	}
+	check(controller->totalAccess() > 0, "full controller wakes a rank");
+	check(!controller->isFull(), "full controller drains");
+
+	delete controller;
+
+	config.queue_capacity = config.pd_wm - 1;
+	check(createController(config) == NULL, "watermark above the queue capacity refused");
+}
+
+// BACKLOG behind QoS admission : the scheduler only ever sees qos_window
+// requests, fewer than the watermark, so what is held back must count.
+static void checkBacklogBehindQoS() {
+	ControllerConfig config;
+	defaultControllerConfig(config);
+	config.sched_policy = BACKLOG;
+	config.pd_policy = CONSERVATIVE;
+	config.qos = true;
+
+	Controller *controller = createController(config);
+	controller->clockTick();
+
+	for(int i=0; i < config.pd_wm; i++) {
+		Request *req = new Request;
+		req->id = 0;
+		req->type = 0;
+		req->rank = 0;
+		req->bank = i % config.num_banks;
+		req->page = 0;
+		req->core = i % config.num_cores;
+		req->bursts = 1;
+		req->start_time = controller->cycle();
+		req->migration = false;
+		req->batched = false;
+		controller->addRequest(req);
+	}
+
+	for(int i=0; i < 10000 && !controller->isQuiescent(); i++) {
+		controller->clockTick();
+	}
+	check(controller->totalAccess() == config.pd_wm, "held back requests reach the watermark");
+
+	delete controller;
+}
+
+// A core QoS never admits fills only its own queue, the others keep
+// issuing
+static void checkQoSIsolation() {
+	ControllerConfig config;
+	defaultControllerConfig(config);
+	config.qos = true;
+	config.qos_rate.assign(1, 0);
+
+	Controller *controller = createController(config);
+
+	unsigned int added[2] = { 0, 0 };
+	for(int core=0; core < 2; core++) {
+		for(int i=0; i < config.queue_capacity + config.qos_depth; i++) {
+			Request *req = new Request;
+			req->id = 0;
+			req->type = 0;
+			req->rank = i % config.num_ranks;
+			req->bank = 0;
+			req->page = 0;
+			req->core = core;
+			req->bursts = 1;
+			req->start_time = controller->cycle();
+			req->migration = false;
+			req->batched = false;
+			if(!controller->addRequest(req)) {
+				delete req;
+				break;
+			}
+			added[core]++;
+		}
+	}
+	check(added[0] == config.qos_depth && controller->isFull(0), "throttled core bounded by its own depth");
+	check(added[1] == config.qos_depth && !controller->isFull(2), "other cores unaffected by a throttled one");
+
+	delete controller;
+}
+
+// A flexible request comes back with the type that served it
+static void checkFlexibleCompletionType() {
+	MemoryConfig config;
+	defaultControllerConfig(config.ctrl);
+	config.max_inflight = 1;
+
+	MemorySystem *memory = MemorySystem::create(config);
+
+	MemRequest mreq;
+	mreq.id = 1;
+	mreq.type = 2;
+	mreq.rank = 0;
+	mreq.bank = 0;
+	mreq.page = 0;
+	mreq.core = 0;
+	mreq.bursts = 1;
+	memory->submit(&mreq, 1);
+
+	MemCompletion completion;
+	unsigned int drained = 0;
+	for(unsigned long int target = 100; target <= 10000 && drained == 0; target += 100) {
+		memory->advance(target);
+		drained = memory->drain(&completion, 1);
+	}
+	check(drained == 1 && completion.type < NUM_TYPES, "flexible request reports the type that served it");
+
+	delete memory;
+}
+
+int main(int argc, char *argv[]) {
+	checkSkipWithRefreshAndTiering();
+	checkBacklogWithFullController();
+	checkBacklogBehindQoS();
+	checkQoSIsolation();
+	checkFlexibleCompletionType();
+
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  hdramstat.cpp
+ *
+ *    Description:  Poll the live stats of a running simulation (./hdram --shm <name>)
+ *
+ *        Version:  1.0
+ *        Created:  06/27/2014 03:40:22 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+#include "shmsegment.h"
+
+using namespace std;
+
+const char status_names[] = { 'I', 'A', 'P', 'S' };
+
+void print_help() {
+	cout << "** Execution: ./hdramstat <Options>" << endl
+		<< endl
+		<< "** Options:" << endl
+		<< "\t-n <Shared-memory name given to ./hdram --shm> (Default : " << SHM_DEFAULT_NAME << ")" << endl
+		<< "\t-i <Poll interval in ms> (Default : 1000)" << endl
+		<< "\t-1 : Print one snapshot and exit" << endl
+		<< "\t-h or --help : Help screen" << endl
+		<< endl
+		<< "** Rank states: I idle, A active, P power-down, S self-refresh" << endl
+		<< endl
+		;
+}
+
+void print_snapshot(const ShmSnapshot &snapshot) {
+	float progress = (snapshot.end_cycle != 0) ? 100.0 * snapshot.cycle / snapshot.end_cycle : 0;
+
+	cout << "Cycle : " << snapshot.cycle << " / " << snapshot.end_cycle
+		<< " (" << (int) progress << "%)" << (snapshot.done ? " done" : "") << endl;
+	cout << "Total Access : " << snapshot.total_access << endl;
+	cout << "Average Latency : " << snapshot.avg_latency << endl;
+	cout << "Average Energy : " << snapshot.avg_energy << endl;
+
+	for(int i=0; i < SHM_NUM_TYPES; i++) {
+		cout << "Type " << i << " backlog/state :";
+		for(int j=0; j < snapshot.num_ranks; j++) {
+			unsigned int status = snapshot.status[i][j];
+			cout << " " << snapshot.backlog[i][j]
+				<< (status < sizeof(status_names) ? status_names[status] : '?');
+		}
+		cout << endl;
+	}
+	cout << endl;
+}
+
+int main(int argc, char *argv[]) {
+	const char *name = SHM_DEFAULT_NAME;
+	unsigned int interval = 1000;
+	bool once = false;
+
+	for(int argi=1; argi < argc; argi++) {
+		if(!strcmp(argv[argi], "-h") || !strcmp(argv[argi], "--help")) {
+			print_help();
+			return 1;
+		}
+
+		if(!strcmp(argv[argi], "-n") && argi + 1 < argc) {
+			name = argv[++argi];
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "-i") && argi + 1 < argc) {
+			interval = atoi(argv[++argi]);
+			continue;
+		}
+
+		if(!strcmp(argv[argi], "-1")) {
+			once = true;
+			continue;
+		}
+
+		cerr << "'" << argv[argi] << "' is not a valid command-line option.\n"
+			<< "Please type './hdramstat --help' for help screen\n\n";
+		return 1;
+	}
+
+	ShmSegment *segment = attachShmStats(name);
+	if(segment == NULL) {
+		cerr << "No simulation is publishing to " << name << "\n\n";
+		return 1;
+	}
+
+	// The simulator unlinks the segment when it finishes, our mapping
+	// still sees the final snapshot
+	while(true) {
+		ShmSnapshot snapshot;
+		if(readShmStats(segment, snapshot)) {
+			print_snapshot(snapshot);
+			if(once || snapshot.done) break;
+		}
+
+		usleep(interval * 1000);
+	}
+
+	detachShmStats(segment);
+	return 0;
+}
@@ -0,0 +1,190 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  libhdram.cpp
+ *
+ *    Description:  Embeddable memory system API (libhdram)
+ *
+ *        Version:  1.0
+ *        Created:  06/14/2014 03:20:11 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#include "libhdram.h"
+
+MemorySystem *MemorySystem::create(const MemoryConfig &config) {
+	if(config.ctrl.num_ranks == 0 || config.ctrl.num_banks == 0 || config.ctrl.queue_depth == 0 || config.ctrl.num_cores == 0 || config.max_inflight == 0) {
+		return NULL;
+	}
+
+	if(config.ctrl.sched_policy >= numSchedPolicies() || config.ctrl.pd_policy >= numPDPolicies() || config.ctrl.refresh > PER_BANK) {
+		return NULL;
+	}
+
+	if(!reachesWatermark(config.ctrl)) {
+		return NULL;
+	}
+
+	return new MemorySystem(config);
+}
+
+MemorySystem::MemorySystem(const MemoryConfig &config_) : config(config_) {
+	controller = createController(config.ctrl);
+	controller->setCompletionHandler(onComplete, this);
+
+	slots.resize(config.max_inflight);
+	free_slots.resize(config.max_inflight);
+	for(int i=0; i < config.max_inflight; i++) {
+		free_slots[i] = &slots[config.max_inflight - 1 - i];
+	}
+	completed.reserve(config.max_inflight);
+
+	callback = NULL;
+	callback_arg = NULL;
+
+	clock = 0;
+}
+
+MemorySystem::~MemorySystem() {
+	// Slots are released wholesale with the pool
+	delete controller;
+}
+
+void MemorySystem::onComplete(Request *req, void *arg) {
+	((MemorySystem *) arg)->complete(req);
+}
+
+void MemorySystem::complete(Request *req) {
+	if(callback == NULL) {
+		completed.push_back(req);
+		return;
+	}
+
+	MemCompletion completion;
+	completion.id = req->id;
+	completion.type = req->placed_type;
+	completion.rank = req->rank;
+	completion.bank = req->bank;
+	completion.core = req->core;
+	completion.start_time = req->start_time;
+	completion.end_time = req->end_time;
+	completion.latency = req->latency;
+
+	release(req);
+	callback(&completion, callback_arg);
+}
+
+void MemorySystem::release(Request *req) {
+	free_slots.push_back(req);
+}
+
+unsigned int MemorySystem::submit(const MemRequest *reqs, unsigned int count) {
+	unsigned int accepted = 0;
+
+	for(; accepted < count; accepted++) {
+		const MemRequest &mreq = reqs[accepted];
+
+		if(mreq.type > NUM_TYPES || mreq.rank >= config.ctrl.num_ranks || mreq.bank >= config.ctrl.num_banks) {
+			break;
+		}
+		if(config.ctrl.num_pages != 0 && mreq.page >= config.ctrl.num_pages) {
+			break;
+		}
+		if(mreq.core >= config.ctrl.num_cores || mreq.bursts > MAX_BURSTS) {
+			break;
+		}
+		if(free_slots.empty() || controller->isFull(mreq.core)) {
+			break;
+		}
+
+		Request *req = free_slots.back();
+		free_slots.pop_back();
+
+		req->id = mreq.id;
+		req->type = mreq.type;
+		req->rank = mreq.rank;
+		req->bank = mreq.bank;
+		req->page = mreq.page;
+		req->core = mreq.core;
+		req->bursts = (mreq.bursts == 0) ? 1 : mreq.bursts;
+		req->migration = false;
+		req->batched = false;
+		req->start_time = clock;
+		req->end_time = 0;
+		req->latency = 0;
+
+		controller->addRequest(req);
+	}
+
+	return accepted;
+}
+
+void MemorySystem::advance(unsigned long int target_cycle) {
+	for(; clock < target_cycle; clock++) {
+		controller->clockTick();
+	}
+}
+
+void MemorySystem::setCallback(MemCompletionCallback callback_, void *arg) {
+	callback = callback_;
+	callback_arg = arg;
+
+	// Flush whatever was buffered before the callback went in
+	if(callback != NULL) {
+		vector<Request *> pending;
+		pending.swap(completed);
+		completed.reserve(config.max_inflight);
+
+		for(int i=0; i < pending.size(); i++) {
+			complete(pending[i]);
+		}
+	}
+}
+
+unsigned int MemorySystem::drain(MemCompletion *out, unsigned int max) {
+	unsigned int count = 0;
+
+	for(; count < max && count < completed.size(); count++) {
+		Request *req = completed[count];
+
+		out[count].id = req->id;
+		out[count].type = req->placed_type;
+		out[count].rank = req->rank;
+		out[count].bank = req->bank;
+		out[count].core = req->core;
+		out[count].start_time = req->start_time;
+		out[count].end_time = req->end_time;
+		out[count].latency = req->latency;
+
+		release(req);
+	}
+
+	completed.erase(completed.begin(), completed.begin() + count);
+
+	return count;
+}
+
+unsigned long int MemorySystem::cycle() {
+	return clock;
+}
+
+unsigned int MemorySystem::inflight() {
+	return config.max_inflight - free_slots.size();
+}
+
+unsigned int MemorySystem::totalAccess() {
+	return controller->totalAccess();
+}
+
+float MemorySystem::avgLatency() {
+	return controller->avgLatency();
+}
+
+float MemorySystem::avgEnergy() {
+	return controller->avgEnergy();
+}
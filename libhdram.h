@@ -0,0 +1,112 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  libhdram.h
+ *
+ *    Description:  Embeddable memory system API (libhdram)
+ *
+ *        Version:  1.0
+ *        Created:  06/14/2014 03:12:40 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#ifndef _LIBHDRAM_H_
+#define _LIBHDRAM_H_
+
+#include <vector>
+
+#include "request.h"
+#include "controller.h"
+
+using namespace std;
+
+struct MemoryConfig {
+	ControllerConfig ctrl;
+
+	// Requests that may be in flight at once. Request storage is allocated
+	// up front; the controller queue (and with QoS the core queues) still
+	// allocate a list node per submission.
+	unsigned int max_inflight;
+};
+
+// What the host simulator hands in
+struct MemRequest {
+	unsigned long int id;
+	unsigned int type; // 0 : fast tier, 1 : low-power tier, 2 : either
+	unsigned int rank;
+	unsigned int bank;
+	unsigned int page; // Used when ctrl.num_pages != 0
+	unsigned int core; // Below ctrl.num_cores
+	unsigned int bursts; // Size in BURST_BYTES bursts, 0 is taken as 1
+};
+
+// What it gets back
+struct MemCompletion {
+	unsigned long int id;
+	unsigned int type; // Tier that actually served the request
+	unsigned int rank;
+	unsigned int bank;
+	unsigned int core;
+	unsigned long int start_time;
+	unsigned long int end_time;
+	unsigned long int latency;
+};
+
+typedef void (*MemCompletionCallback)(const MemCompletion *completion, void *arg);
+
+class MemorySystem {
+private:
+	Controller *controller;
+	unsigned long int clock;
+
+	// Request pool
+	vector<Request> slots;
+	vector<Request *> free_slots;
+
+	// Completions waiting for drain()
+	vector<Request *> completed;
+
+	MemCompletionCallback callback;
+	void *callback_arg;
+
+	// Config
+	MemoryConfig config;
+
+	MemorySystem(const MemoryConfig &config_);
+
+	static void onComplete(Request *req, void *arg);
+	void complete(Request *req);
+	void release(Request *req);
+
+public:
+	// Returns NULL when the config is invalid
+	static MemorySystem *create(const MemoryConfig &config);
+	~MemorySystem();
+
+	// Returns the number of leading requests accepted; stops at the first
+	// malformed request, when every slot is in flight or when the controller
+	// queue is full (ctrl.queue_capacity, with QoS ctrl.qos_depth per core)
+	unsigned int submit(const MemRequest *reqs, unsigned int count);
+
+	// Tick the memory system until cycle() == target_cycle
+	void advance(unsigned long int target_cycle);
+
+	// With a callback installed completions are delivered from inside
+	// advance(), otherwise they are buffered until drain()
+	void setCallback(MemCompletionCallback callback_, void *arg);
+	unsigned int drain(MemCompletion *out, unsigned int max);
+
+	unsigned long int cycle();
+	unsigned int inflight();
+
+	unsigned int totalAccess();
+	float avgLatency();
+	float avgEnergy();
+};
+
+#endif
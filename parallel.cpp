@@ -0,0 +1,86 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  parallel.cpp
+ *
+ *    Description:  Run independent simulations on worker threads
+ *
+ *        Version:  1.0
+ *        Created:  06/24/2014 10:26:03 AM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#include <vector>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "parallel.h"
+
+using namespace std;
+
+struct ParallelJob {
+	unsigned int count;
+	ParallelBody body;
+	void *arg;
+
+	unsigned int next; // Next index to hand out
+	pthread_mutex_t lock;
+};
+
+static void *parallelWorker(void *arg) {
+	ParallelJob *job = (ParallelJob *) arg;
+
+	while(true) {
+		pthread_mutex_lock(&job->lock);
+		unsigned int index = job->next++;
+		pthread_mutex_unlock(&job->lock);
+
+		if(index >= job->count) {
+			break;
+		}
+
+		job->body(index, job->arg);
+	}
+
+	return NULL;
+}
+
+unsigned int defaultThreads() {
+	long int cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	return (cpus > 0) ? cpus : 1;
+}
+
+void parallelFor(unsigned int count, unsigned int num_threads, ParallelBody body, void *arg) {
+	ParallelJob job;
+	job.count = count;
+	job.body = body;
+	job.arg = arg;
+	job.next = 0;
+
+	if(num_threads > count) num_threads = count;
+
+	// Not worth a thread
+	if(num_threads <= 1) {
+		for(unsigned int i=0; i < count; i++) {
+			body(i, arg);
+		}
+		return;
+	}
+
+	pthread_mutex_init(&job.lock, NULL);
+
+	vector<pthread_t> threads(num_threads);
+	for(int i=0; i < num_threads; i++) {
+		pthread_create(&threads[i], NULL, parallelWorker, &job);
+	}
+	for(int i=0; i < num_threads; i++) {
+		pthread_join(threads[i], NULL);
+	}
+
+	pthread_mutex_destroy(&job.lock);
+}
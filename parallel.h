@@ -0,0 +1,29 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  parallel.h
+ *
+ *    Description:  Run independent simulations on worker threads
+ *
+ *        Version:  1.0
+ *        Created:  06/24/2014 10:18:55 AM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#ifndef _PARALLEL_H_
+#define _PARALLEL_H_
+
+typedef void (*ParallelBody)(unsigned int index, void *arg);
+
+unsigned int defaultThreads(); // Online CPUs
+
+// Call body(i, arg) for every i < count, spread over up to num_threads
+// threads. Returns once all calls are done.
+void parallelFor(unsigned int count, unsigned int num_threads, ParallelBody body, void *arg);
+
+#endif
@@ -0,0 +1,154 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  policy.cpp
+ *
+ *    Description:  Registry of scheduling and power-down policies
+ *
+ *        Version:  1.0
+ *        Created:  06/30/2014 11:02:51 AM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#include <cstdlib>
+#include <cctype>
+#include <cstring>
+
+#include "policy.h"
+
+typedef Controller *(*ControllerFactory)(const ControllerConfig &config);
+
+template<class Sched, class PD>
+static Controller *makeController(const ControllerConfig &config) {
+	return new PolicyController<Sched, PD>(config);
+}
+
+// Every scheduling policy is instantiated with every power-down policy, a
+// new power-down policy is one more name here and one more factory in
+// SCHED_ENTRY. Order gives the policy numbers, built-ins first.
+const unsigned int NUM_PD_POLICIES = 3;
+
+struct PDEntry {
+	const char *name;
+	bool uses_watermark;
+	bool uses_timeout;
+};
+
+#define PD_ENTRY(PD) { PD::name(), PD::usesWatermark(), PD::usesTimeout() }
+
+static const PDEntry pd_registry[NUM_PD_POLICIES] = {
+	PD_ENTRY(NoPowerDown),
+	PD_ENTRY(ConservativePowerDown),
+	PD_ENTRY(WatermarkPowerDown)
+};
+
+struct SchedEntry {
+	const char *name;
+	bool uses_watermark;
+	bool uses_timeout;
+	ControllerFactory create[NUM_PD_POLICIES];
+};
+
+#define SCHED_ENTRY(Sched) { Sched::name(), Sched::usesWatermark(), Sched::usesTimeout(), { \
+	makeController<Sched, NoPowerDown>, \
+	makeController<Sched, ConservativePowerDown>, \
+	makeController<Sched, WatermarkPowerDown> } }
+
+static const SchedEntry sched_registry[] = {
+	SCHED_ENTRY(FifoSched),
+	SCHED_ENTRY(PDAwareSched),
+	SCHED_ENTRY(BacklogSched),
+	SCHED_ENTRY(CostSched)
+};
+
+const unsigned int NUM_SCHED_POLICIES = sizeof(sched_registry) / sizeof(sched_registry[0]);
+
+unsigned int numSchedPolicies() {
+	return NUM_SCHED_POLICIES;
+}
+
+unsigned int numPDPolicies() {
+	return NUM_PD_POLICIES;
+}
+
+bool parseSchedPolicy(const char *arg, SchedPolicy &policy) {
+	for(int i=0; i < NUM_SCHED_POLICIES; i++) {
+		if(!strcmp(arg, sched_registry[i].name) || (isdigit(arg[0]) && atoi(arg) == i)) {
+			policy = (SchedPolicy) i;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool parsePDPolicy(const char *arg, PDPolicy &policy) {
+	for(int i=0; i < NUM_PD_POLICIES; i++) {
+		if(!strcmp(arg, pd_registry[i].name) || (isdigit(arg[0]) && atoi(arg) == i)) {
+			policy = (PDPolicy) i;
+			return true;
+		}
+	}
+	return false;
+}
+
+const char *schedPolicyName(SchedPolicy policy) {
+	return (policy < NUM_SCHED_POLICIES) ? sched_registry[policy].name : "unknown";
+}
+
+const char *pdPolicyName(PDPolicy policy) {
+	return (policy < NUM_PD_POLICIES) ? pd_registry[policy].name : "unknown";
+}
+
+bool usesWatermark(const ControllerConfig &config) {
+	if(config.sched_policy >= NUM_SCHED_POLICIES || config.pd_policy >= NUM_PD_POLICIES) {
+		return false;
+	}
+	return sched_registry[config.sched_policy].uses_watermark || pd_registry[config.pd_policy].uses_watermark;
+}
+
+bool usesTimeout(const ControllerConfig &config) {
+	if(config.sched_policy >= NUM_SCHED_POLICIES || config.pd_policy >= NUM_PD_POLICIES) {
+		return false;
+	}
+	return sched_registry[config.sched_policy].uses_timeout || pd_registry[config.pd_policy].uses_timeout;
+}
+
+// Only a scheduler reading the watermark holds a powered-down rank's
+// requests back until it is reached
+bool reachesWatermark(const ControllerConfig &config) {
+	if(config.sched_policy >= NUM_SCHED_POLICIES || !sched_registry[config.sched_policy].uses_watermark) {
+		return true;
+	}
+
+	// With QoS the held back requests count as well, up to qos_depth a core
+	if(config.qos) {
+		if(config.qos_depth == 0) {
+			return true;
+		}
+
+		unsigned int visible = config.qos_window;
+		if(config.queue_capacity != 0 && config.queue_capacity < visible) {
+			visible = config.queue_capacity;
+		}
+		return visible + config.num_cores * config.qos_depth >= config.pd_wm;
+	}
+
+	return config.queue_capacity == 0 || config.queue_capacity >= config.pd_wm;
+}
+
+Controller *createController(const ControllerConfig &config) {
+	if(config.sched_policy >= NUM_SCHED_POLICIES || config.pd_policy >= NUM_PD_POLICIES) {
+		return NULL;
+	}
+
+	if(!reachesWatermark(config)) {
+		return NULL;
+	}
+
+	return sched_registry[config.sched_policy].create[config.pd_policy](config);
+}
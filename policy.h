@@ -0,0 +1,283 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  policy.h
+ *
+ *    Description:  Scheduling and power-down policies, statically bound to the controller
+ *
+ *        Version:  1.0
+ *        Created:  06/30/2014 10:12:08 AM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#ifndef _POLICY_H_
+#define _POLICY_H_
+
+#include "controller.h"
+
+// A scheduling policy is a class with
+//     static const char *name();
+//     static bool usesWatermark(); // Reads pd_wm (the tuner searches it)
+//     static bool usesTimeout();   // Reads timeout
+//     static void schedule(Controller &ctrl); // Once per cycle
+// and a power-down policy one with the same name() and knob traits and
+//     static void powerDown(Controller &ctrl); // Once per cycle, after scheduling
+// Register new ones in policy.cpp to make them selectable by name.
+
+template<class Sched, class PD>
+class PolicyController : public Controller {
+public:
+	PolicyController(const ControllerConfig &config) : Controller(config) {}
+
+	void clockTick() {
+		beginTick();
+		Sched::schedule(*this);
+		PD::powerDown(*this);
+		endTick();
+	}
+};
+
+// Scheduling
+//
+// The FIFO-order policies pull the same-row requests queued right behind
+// the one they dispatch along with it (dispatchFollowers, with --pages)
+
+// Oldest request first, flexible requests to the shorter bank queue
+struct FifoSched {
+	static const char *name() { return "fifo"; }
+	static bool usesWatermark() { return false; }
+	static bool usesTimeout() { return false; }
+
+	static void schedule(Controller &ctrl) {
+		list<Request *> &pending = ctrl.pendingRequests();
+		if(pending.empty()) return;
+
+		Request *req = pending.front();
+		unsigned int type = (req->type == 2) ? ctrl.placeShorter(req) : req->type;
+
+		// Head of the line waits for room in its bank
+		if(!ctrl.accepts(req, type)) return;
+		pending.pop_front();
+
+		ctrl.dispatch(req, type);
+		ctrl.dispatchFollowers(req, type);
+		if(ctrl.isPoweredDown(type, req->rank)) {
+			ctrl.wake(type, req->rank);
+		}
+	}
+};
+
+// FIFO, but flexible requests go to whichever type of the rank is awake
+// and never wake one up
+struct PDAwareSched {
+	static const char *name() { return "pd_aware"; }
+	static bool usesWatermark() { return false; }
+	static bool usesTimeout() { return false; }
+
+	static void schedule(Controller &ctrl) {
+		list<Request *> &pending = ctrl.pendingRequests();
+		if(pending.empty()) return;
+
+		Request *req = pending.front();
+
+		unsigned int type = req->type;
+		if(req->type == 2) {
+			bool down0 = ctrl.isPoweredDown(0, req->rank);
+			bool down1 = ctrl.isPoweredDown(1, req->rank);
+
+			if(!down0 && down1) {
+				type = 0;
+			} else if(down0 && !down1) {
+				type = 1;
+			} else {
+				type = ctrl.placeShorter(req);
+			}
+		}
+
+		if(!ctrl.accepts(req, type)) return;
+		pending.pop_front();
+
+		ctrl.dispatch(req, type);
+		ctrl.dispatchFollowers(req, type);
+		if(req->type != 2 && ctrl.isPoweredDown(type, req->rank)) {
+			ctrl.wake(type, req->rank);
+		}
+	}
+};
+
+// First request whose rank is awake, or whose powered-down rank has
+// reached the watermark (counting what QoS holds back). Anything waiting longer than the timeout goes
+// out FIFO.
+struct BacklogSched {
+	static const char *name() { return "backlog"; }
+	static bool usesWatermark() { return true; }
+	static bool usesTimeout() { return true; }
+
+	// A saturated controller takes no new request, so no powered-down rank
+	// can climb further. The one with the most queued for it counts as
+	// having reached the watermark.
+	static void fullestAsleep(Controller &ctrl, int &type, int &rank) {
+		unsigned int most = 0;
+		type = -1;
+		rank = -1;
+
+		for(int i=0; i < NUM_TYPES; i++) {
+			for(int j=0; j < ctrl.numRanks(); j++) {
+				if(ctrl.isPoweredDown(i, j) && ctrl.queuedRequests(i, j) > most) {
+					most = ctrl.queuedRequests(i, j);
+					type = i;
+					rank = j;
+				}
+			}
+		}
+	}
+
+	static void schedule(Controller &ctrl) {
+		list<Request *> &pending = ctrl.pendingRequests();
+		unsigned long int timeout = ctrl.schedTimeout();
+		unsigned int pd_wm = ctrl.watermark();
+
+		int full_type = -1, full_rank = -1;
+		if(ctrl.isSaturated()) {
+			fullestAsleep(ctrl, full_type, full_rank);
+		}
+
+		list<Request *>::iterator it = pending.begin();
+		for(; it != pending.end(); it++) {
+			Request *req = *it;
+
+			// Blocked too long, schedule it instantly
+			if(timeout != 0 && (ctrl.cycle() - req->start_time) > timeout) {
+				unsigned int type = (req->type == 2) ? ctrl.placeShorter(req) : req->type;
+				if(!ctrl.accepts(req, type)) continue;
+
+				ctrl.dispatch(req, type);
+				if(ctrl.isPoweredDown(type, req->rank)) {
+					ctrl.wake(type, req->rank);
+				}
+				pending.erase(it);
+				return;
+			}
+
+			// Pick the type, and whether it must be woken, first
+			unsigned int type = req->type;
+			bool wake = false;
+			if(req->type == 2) {
+				bool down0 = ctrl.isPoweredDown(0, req->rank);
+				bool down1 = ctrl.isPoweredDown(1, req->rank);
+
+				if(!down0 && down1) {
+					type = 0;
+				} else if(down0 && !down1) {
+					type = 1;
+				} else if(!down0 && !down1) {
+					type = ctrl.placeShorter(req);
+				} else if(ctrl.wakeDemand(0, req->rank) >= pd_wm || (full_type == 0 && full_rank == req->rank)) {
+					// Both powered down, wake the first at its watermark
+					type = 0;
+					wake = true;
+				} else if(ctrl.wakeDemand(1, req->rank) >= pd_wm || (full_type == 1 && full_rank == req->rank)) {
+					type = 1;
+					wake = true;
+				} else {
+					continue;
+				}
+			} else if(ctrl.isPoweredDown(req->type, req->rank)) {
+				if(ctrl.typeWakeDemand(req->type, req->rank) < pd_wm && !(full_type == req->type && full_rank == req->rank)) {
+					continue;
+				}
+				wake = true;
+			}
+
+			// A full bank only holds back its own requests
+			if(!ctrl.accepts(req, type)) continue;
+
+			ctrl.dispatch(req, type);
+			if(wake) {
+				ctrl.wake(type, req->rank);
+			}
+			pending.erase(it);
+			return;
+		}
+	}
+};
+
+// FIFO, flexible requests placed by the latency/energy cost model
+struct CostSched {
+	static const char *name() { return "cost"; }
+	static bool usesWatermark() { return false; }
+	static bool usesTimeout() { return false; }
+
+	static void schedule(Controller &ctrl) {
+		list<Request *> &pending = ctrl.pendingRequests();
+		if(pending.empty()) return;
+
+		Request *req = pending.front();
+		unsigned int type = (req->type == 2) ? ctrl.placeFlexible(req) : req->type;
+
+		if(!ctrl.accepts(req, type)) return;
+		pending.pop_front();
+
+		ctrl.dispatch(req, type);
+		ctrl.dispatchFollowers(req, type);
+
+		Status status = ctrl.rankOf(type, req->rank)->getStatus();
+		if(status == POWER_DOWN || status == SELF_REFRESH) {
+			ctrl.wake(type, req->rank);
+		}
+	}
+};
+
+// Power-down
+
+struct NoPowerDown {
+	static const char *name() { return "none"; }
+	static bool usesWatermark() { return false; }
+	static bool usesTimeout() { return false; }
+
+	static void powerDown(Controller &ctrl) {}
+};
+
+// As soon as a rank has nothing in service or queued for it
+struct ConservativePowerDown {
+	static const char *name() { return "conservative"; }
+	static bool usesWatermark() { return false; }
+	static bool usesTimeout() { return false; }
+
+	static void powerDown(Controller &ctrl) {
+		for(int i=0; i < NUM_TYPES; i++) {
+			for(int j=0; j < ctrl.numRanks(); j++) {
+				// Never with a request still in service, it would be stranded
+				if(ctrl.rankOf(i, j)->isQuiescent() && ctrl.queuedRequests(i, j) == 0) {
+					ctrl.sleep(i, j);
+				}
+			}
+		}
+	}
+};
+
+// Whenever a rank's backlog is below the watermark
+struct WatermarkPowerDown {
+	static const char *name() { return "watermark"; }
+	static bool usesWatermark() { return true; }
+	static bool usesTimeout() { return false; }
+
+	static void powerDown(Controller &ctrl) {
+		unsigned int pd_wm = ctrl.watermark();
+
+		for(int i=0; i < NUM_TYPES; i++) {
+			for(int j=0; j < ctrl.numRanks(); j++) {
+				if(ctrl.demand(i, j) < pd_wm) {
+					ctrl.sleep(i, j);
+				}
+			}
+		}
+	}
+};
+
+#endif
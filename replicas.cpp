@@ -0,0 +1,107 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  replicas.cpp
+ *
+ *    Description:  Independent replicas of one configuration with confidence intervals
+ *
+ *        Version:  1.0
+ *        Created:  06/24/2014 11:15:40 AM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#include <cmath>
+#include <time.h>
+
+#include "replicas.h"
+#include "parallel.h"
+
+// Two-sided 95% Student t quantiles for 1..30 degrees of freedom
+const float t_quantile[] = {
+	12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+	2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+	2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+struct ReplicaJob {
+	SimConfig config;
+	unsigned int seed;
+	vector<SimResult> *runs;
+};
+
+static void runReplica(unsigned int index, void *arg) {
+	ReplicaJob *job = (ReplicaJob *) arg;
+
+	SimConfig config = job->config;
+	config.seed = job->seed + 1000*index; // Cores take seed, seed+1, ...
+
+	runSimulation(config, (*job->runs)[index], false);
+}
+
+static Estimate estimate(const vector<float> &samples) {
+	Estimate est;
+	unsigned int n = samples.size();
+
+	double sum = 0;
+	for(int i=0; i < n; i++) {
+		sum += samples[i];
+	}
+	est.mean = sum / n;
+
+	if(n < 2) {
+		est.ci = 0;
+		return est;
+	}
+
+	double sq = 0;
+	for(int i=0; i < n; i++) {
+		sq += (samples[i] - est.mean) * (samples[i] - est.mean);
+	}
+	double stddev = sqrt(sq / (n - 1));
+
+	float t = (n - 1 <= 30) ? t_quantile[n - 2] : 1.96;
+	est.ci = t * stddev / sqrt((double) n);
+
+	return est;
+}
+
+template<class T>
+static Estimate estimateOf(const vector<SimResult> &runs, T SimResult::*metric) {
+	vector<float> samples(runs.size());
+	for(int i=0; i < runs.size(); i++) {
+		samples[i] = runs[i].*metric;
+	}
+	return estimate(samples);
+}
+
+void runReplicas(const SimConfig &config, unsigned int num_replicas, unsigned int num_threads, ReplicaResult &result) {
+	ReplicaJob job;
+	job.config = config;
+	job.seed = (config.seed != 0) ? config.seed : time(NULL);
+	job.runs = &result.runs;
+
+	result.runs.resize(num_replicas);
+	parallelFor(num_replicas, num_threads, runReplica, &job);
+
+	const vector<SimResult> &runs = result.runs;
+	result.total_access = estimateOf(runs, &SimResult::total_access);
+	result.migration_access = estimateOf(runs, &SimResult::migration_access);
+	result.promotions = estimateOf(runs, &SimResult::promotions);
+	result.demotions = estimateOf(runs, &SimResult::demotions);
+	result.avg_latency = estimateOf(runs, &SimResult::avg_latency);
+	result.p99_latency = estimateOf(runs, &SimResult::p99_latency);
+	result.avg_energy = estimateOf(runs, &SimResult::avg_energy);
+	result.ed_product = estimateOf(runs, &SimResult::ed_product);
+	result.backpressure = estimateOf(runs, &SimResult::backpressure);
+	result.refreshes = estimateOf(runs, &SimResult::refreshes);
+	result.stall_cycles = estimateOf(runs, &SimResult::stall_cycles);
+	result.rejected = estimateOf(runs, &SimResult::rejected);
+	result.total_bytes = estimateOf(runs, &SimResult::total_bytes);
+	result.latency_per_byte = estimateOf(runs, &SimResult::latency_per_byte);
+	result.energy_per_byte = estimateOf(runs, &SimResult::energy_per_byte);
+}
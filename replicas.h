@@ -0,0 +1,58 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  replicas.h
+ *
+ *    Description:  Independent replicas of one configuration with confidence intervals
+ *
+ *        Version:  1.0
+ *        Created:  06/24/2014 11:02:17 AM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#ifndef _REPLICAS_H_
+#define _REPLICAS_H_
+
+#include <vector>
+
+#include "simulator.h"
+
+using namespace std;
+
+struct Estimate {
+	float mean;
+	float ci; // Half-width of the 95% confidence interval
+};
+
+// One estimate per aggregate of SimResult
+struct ReplicaResult {
+	vector<SimResult> runs;
+
+	Estimate total_access;
+	Estimate migration_access;
+	Estimate promotions;
+	Estimate demotions;
+	Estimate avg_latency;
+	Estimate p99_latency;
+	Estimate avg_energy;
+	Estimate ed_product;
+	Estimate backpressure;
+	Estimate refreshes;
+	Estimate stall_cycles;
+	Estimate rejected;
+	Estimate total_bytes;
+	Estimate latency_per_byte;
+	Estimate energy_per_byte;
+};
+
+// Run num_replicas copies of the configuration with seeds config.seed,
+// config.seed+1000, ... on up to num_threads threads. Every replica is a
+// full, independent simulation.
+void runReplicas(const SimConfig &config, unsigned int num_replicas, unsigned int num_threads, ReplicaResult &result);
+
+#endif
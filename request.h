@@ -21,11 +21,21 @@
 #include <iostream>
 using namespace std;
 
+const unsigned int BURST_BYTES = 64; // One cache line per burst
+const unsigned int MAX_BURSTS = 64;
+
 struct Request {
+	// Tag handed back on completion (library clients)
+	unsigned long int id;
+
 	// Address map
 	unsigned int type; // NOTE: Supports only two types for now
+	unsigned int placed_type; // Type the controller dispatched it to, 0 or 1 even for type 2
 	unsigned int rank;
 	unsigned int bank;
+	unsigned int page; // Only meaningful with tiering
+	unsigned int core; // Issuing core
+	unsigned int bursts; // Back-to-back transfers of BURST_BYTES
 
 	// Latency book keep
 	unsigned long int start_time;
@@ -33,6 +43,9 @@ struct Request {
 	unsigned long int latency;
 
 	// Other counters
+	bool migration; // Tiering traffic, kept out of demand stats
+	unsigned int migrate_to; // Migration : type the page moves to, the read is the half with type != migrate_to
+	bool batched;   // Follows a request to the same row of its bank, no activation
 };
 
 ostream &operator<<(ostream &out, Request &req);
@@ -0,0 +1,375 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  results.cpp
+ *
+ *    Description:  Machine-readable report of a run (JSON or CSV)
+ *
+ *        Version:  1.0
+ *        Created:  07/03/2014 02:21:55 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <cstring>
+
+#include "results.h"
+
+using namespace std;
+
+struct Field {
+	string name;
+	string value;
+	bool text; // Quoted in JSON
+};
+
+typedef vector<Field> Fields;
+
+template<class T>
+static void addField(Fields &fields, const string &name, T value) {
+	ostringstream out;
+	out << setprecision(10) << value;
+
+	Field field;
+	field.name = name;
+	field.value = out.str();
+	field.text = false;
+	fields.push_back(field);
+}
+
+static void addText(Fields &fields, const string &name, const string &value) {
+	Field field;
+	field.name = name;
+	field.value = value;
+	field.text = true;
+	fields.push_back(field);
+}
+
+template<class T>
+static string joinList(const vector<T> &values) {
+	ostringstream out;
+	for(int i=0; i < values.size(); i++) {
+		if(i != 0) out << ';';
+		out << values[i];
+	}
+	return out.str();
+}
+
+static void configFields(const SimConfig &config, const SimResult &result, Fields &fields) {
+	const ControllerConfig &ctrl = config.ctrl;
+
+	addField(fields, "warmup_time", config.warmup_time);
+	addField(fields, "sim_time", config.sim_time);
+	addField(fields, "num_cores", config.num_cores);
+	addField(fields, "mem_intensity", config.mem_intensity);
+	addField(fields, "type1_intensity", config.type1_intensity);
+	addField(fields, "type2_intensity", config.type2_intensity);
+	addField(fields, "page_skew", config.page_skew);
+	addField(fields, "max_bursts", config.max_bursts);
+	addField(fields, "seed", result.seed);
+
+	addField(fields, "num_ranks", ctrl.num_ranks);
+	addField(fields, "num_banks", ctrl.num_banks);
+	addField(fields, "queue_depth", ctrl.queue_depth);
+	addField(fields, "queue_capacity", ctrl.queue_capacity);
+	addText(fields, "sched_policy", schedPolicyName(ctrl.sched_policy));
+	addText(fields, "pd_policy", pdPolicyName(ctrl.pd_policy));
+	addField(fields, "pd_wm", ctrl.pd_wm);
+	addField(fields, "timeout", ctrl.timeout);
+	addField(fields, "sr_timeout", ctrl.sr_timeout);
+	addText(fields, "refresh", refreshModeName(ctrl.refresh));
+	addField(fields, "placement_weight", ctrl.placement_weight);
+	addField(fields, "num_pages", ctrl.num_pages);
+	addField(fields, "tier_epoch", ctrl.tier_epoch);
+	addField(fields, "tier_hot", ctrl.tier_hot);
+	addField(fields, "tier_capacity", ctrl.tier_capacity);
+	addField(fields, "tier_migrations", ctrl.tier_migrations);
+	addField(fields, "qos", ctrl.qos ? 1 : 0);
+	addText(fields, "qos_rate", joinList(ctrl.qos_rate));
+	addText(fields, "qos_class", joinList(ctrl.qos_class));
+	addField(fields, "qos_burst", ctrl.qos_burst);
+	addField(fields, "qos_window", ctrl.qos_window);
+	addField(fields, "qos_depth", ctrl.qos_depth);
+}
+
+static void resultFields(const SimResult &result, Fields &fields) {
+	addField(fields, "total_access", result.total_access);
+	addField(fields, "migration_access", result.migration_access);
+	addField(fields, "promotions", result.promotions);
+	addField(fields, "demotions", result.demotions);
+	addField(fields, "avg_latency", result.avg_latency);
+	addField(fields, "p99_latency", result.p99_latency);
+	addField(fields, "avg_energy", result.avg_energy);
+	addField(fields, "ed_product", result.ed_product);
+	addField(fields, "backpressure", result.backpressure);
+	addField(fields, "refreshes", result.refreshes);
+	addField(fields, "stall_cycles", result.stall_cycles);
+	addField(fields, "rejected", result.rejected);
+	addField(fields, "total_bytes", result.total_bytes);
+	addField(fields, "latency_per_byte", result.latency_per_byte);
+	addField(fields, "energy_per_byte", result.energy_per_byte);
+}
+
+static void hostFields(const SimResult &result, Fields &fields) {
+	addField(fields, "wall_time", result.wall_time);
+	addField(fields, "ticked_cycles", result.ticked_cycles);
+	addField(fields, "skipped_cycles", result.skipped_cycles);
+	addField(fields, "sim_cycles", result.ticked_cycles + result.skipped_cycles);
+	addField(fields, "cycles_per_sec", result.cycles_per_sec);
+}
+
+static void typeFields(const SimResult &result, unsigned int type, Fields &fields) {
+	addField(fields, "type", type);
+	addField(fields, "access", result.type_access[type]);
+	addField(fields, "avg_latency", result.type_latency[type]);
+}
+
+static void rankFields(const SimResult &result, unsigned int type, unsigned int rank, Fields &fields) {
+	const RankResult &rank_result = result.rank_result[type][rank];
+	const EnergyBreakdown &energy = rank_result.energy;
+
+	addField(fields, "type", type);
+	addField(fields, "rank", rank);
+	addField(fields, "access", rank_result.access);
+	addField(fields, "migration_access", rank_result.migration_access);
+	addField(fields, "avg_latency", rank_result.avg_latency);
+	addField(fields, "active_cycles", rank_result.active_cycles);
+	addField(fields, "idle_cycles", rank_result.idle_cycles);
+	addField(fields, "power_down_cycles", rank_result.power_down_cycles);
+	addField(fields, "self_refresh_cycles", rank_result.self_refresh_cycles);
+	addField(fields, "refreshes", rank_result.refreshes);
+	addField(fields, "energy_dynamic", energy.dynamic);
+	addField(fields, "energy_idle", energy.idle);
+	addField(fields, "energy_power_down", energy.power_down);
+	addField(fields, "energy_self_refresh", energy.self_refresh);
+	addField(fields, "energy_refresh", energy.refresh);
+	addField(fields, "energy_total", energy.dynamic + energy.idle + energy.power_down + energy.self_refresh + energy.refresh);
+}
+
+static void coreFields(const SimResult &result, unsigned int core, Fields &fields) {
+	addField(fields, "core", core);
+	addField(fields, "access", result.core_access[core]);
+	addField(fields, "avg_latency", result.core_latency[core]);
+	addField(fields, "bandwidth", result.core_bandwidth[core]);
+	addField(fields, "stall_cycles", result.core_stall[core]);
+}
+
+// JSON
+
+static void writeObject(ostream &out, const Fields &fields, const char *indent) {
+	out << "{" << endl;
+	for(int i=0; i < fields.size(); i++) {
+		out << indent << "\t\"" << fields[i].name << "\": ";
+		if(fields[i].text) {
+			out << "\"" << fields[i].value << "\"";
+		} else {
+			out << fields[i].value;
+		}
+		out << ((i + 1 < fields.size()) ? "," : "") << endl;
+	}
+	out << indent << "}";
+}
+
+static void writeArray(ostream &out, const vector<Fields> &objects) {
+	out << "[" << endl;
+	for(int i=0; i < objects.size(); i++) {
+		out << "\t\t";
+		writeObject(out, objects[i], "\t\t");
+		out << ((i + 1 < objects.size()) ? "," : "") << endl;
+	}
+	out << "\t]";
+}
+
+static void writeJSON(ostream &out, const Fields &config, const Fields &result, const Fields &host,
+		const vector<Fields> &types, const vector<Fields> &ranks, const vector<Fields> &cores) {
+	out << "{" << endl;
+	out << "\t\"config\": "; writeObject(out, config, "\t"); out << "," << endl;
+	out << "\t\"result\": "; writeObject(out, result, "\t"); out << "," << endl;
+	out << "\t\"types\": "; writeArray(out, types); out << "," << endl;
+	out << "\t\"ranks\": "; writeArray(out, ranks); out << "," << endl;
+	out << "\t\"cores\": "; writeArray(out, cores); out << "," << endl;
+	out << "\t\"host\": "; writeObject(out, host, "\t"); out << endl;
+	out << "}" << endl;
+}
+
+// CSV, one flat row with prefixed column names
+
+static void flatten(const Fields &fields, const string &prefix, Fields &row) {
+	for(int i=0; i < fields.size(); i++) {
+		Field field = fields[i];
+		field.name = prefix + field.name;
+		row.push_back(field);
+	}
+}
+
+static string csvHeader(const Fields &row) {
+	ostringstream out;
+	for(int i=0; i < row.size(); i++) {
+		out << (i ? "," : "") << row[i].name;
+	}
+	return out.str();
+}
+
+static void writeCSV(ostream &out, bool header, const Fields &row) {
+	if(header) {
+		out << csvHeader(row) << endl;
+	}
+
+	for(int i=0; i < row.size(); i++) {
+		out << (i ? "," : "") << row[i].value;
+	}
+	out << endl;
+}
+
+// Stdout, or the file truncated for JSON and appended to for CSV. NULL if
+// it cannot be opened. The header only goes into a new or empty CSV
+// file; the columns depend on the rank and core counts, so a row only goes
+// under its own header.
+static ostream *openResults(const char *path, ResultFormat format, const Fields &row, ofstream &file, bool &header) {
+	header = true;
+	if(!strcmp(path, "-")) {
+		return &cout;
+	}
+
+	if(format == CSV) {
+		ifstream existing(path);
+		header = !existing.good() || existing.peek() == ifstream::traits_type::eof();
+		if(!header) {
+			string line;
+			getline(existing, line);
+			if(line != csvHeader(row)) {
+				cerr << path << " has other columns (different -r / -c ?), not appending\n";
+				return NULL;
+			}
+		}
+		file.open(path, ios::out | ios::app);
+	} else {
+		file.open(path, ios::out | ios::trunc);
+	}
+
+	return file.is_open() ? &file : NULL;
+}
+
+bool writeResults(const char *path, ResultFormat format, const SimConfig &config, const SimResult &result) {
+	Fields config_fields, result_fields, host_fields;
+	configFields(config, result, config_fields);
+	resultFields(result, result_fields);
+	hostFields(result, host_fields);
+
+	vector<Fields> types(NUM_TYPES), ranks, cores(result.core_access.size());
+	for(int i=0; i < NUM_TYPES; i++) {
+		typeFields(result, i, types[i]);
+		for(int j=0; j < result.rank_result[i].size(); j++) {
+			ranks.push_back(Fields());
+			rankFields(result, i, j, ranks.back());
+		}
+	}
+	for(int i=0; i < cores.size(); i++) {
+		coreFields(result, i, cores[i]);
+	}
+
+	Fields row;
+	if(format == CSV) {
+		flatten(config_fields, "config.", row);
+		flatten(result_fields, "result.", row);
+		for(int i=0; i < types.size(); i++) {
+			ostringstream prefix;
+			prefix << "type" << i << ".";
+			flatten(types[i], prefix.str(), row);
+		}
+		for(int i=0; i < ranks.size(); i++) {
+			ostringstream prefix;
+			prefix << "type" << ranks[i][0].value << ".rank" << ranks[i][1].value << ".";
+			flatten(ranks[i], prefix.str(), row);
+		}
+		for(int i=0; i < cores.size(); i++) {
+			ostringstream prefix;
+			prefix << "core" << i << ".";
+			flatten(cores[i], prefix.str(), row);
+		}
+		flatten(host_fields, "host.", row);
+	}
+
+	ofstream file;
+	bool header;
+	ostream *out = openResults(path, format, row, file, header);
+	if(out == NULL) {
+		return false;
+	}
+
+	if(format == JSON) {
+		writeJSON(*out, config_fields, result_fields, host_fields, types, ranks, cores);
+	} else {
+		writeCSV(*out, header, row);
+	}
+
+	return true;
+}
+
+static void addEstimate(Fields &fields, const string &name, const Estimate &est) {
+	addField(fields, name + "_mean", est.mean);
+	addField(fields, name + "_ci", est.ci);
+}
+
+bool writeReplicaResults(const char *path, ResultFormat format, const SimConfig &config, const ReplicaResult &replicas) {
+	Fields config_fields, result_fields;
+	configFields(config, replicas.runs[0], config_fields);
+	addField(config_fields, "replicas", replicas.runs.size());
+
+	addEstimate(result_fields, "total_access", replicas.total_access);
+	addEstimate(result_fields, "migration_access", replicas.migration_access);
+	addEstimate(result_fields, "promotions", replicas.promotions);
+	addEstimate(result_fields, "demotions", replicas.demotions);
+	addEstimate(result_fields, "avg_latency", replicas.avg_latency);
+	addEstimate(result_fields, "p99_latency", replicas.p99_latency);
+	addEstimate(result_fields, "avg_energy", replicas.avg_energy);
+	addEstimate(result_fields, "ed_product", replicas.ed_product);
+	addEstimate(result_fields, "backpressure", replicas.backpressure);
+	addEstimate(result_fields, "refreshes", replicas.refreshes);
+	addEstimate(result_fields, "stall_cycles", replicas.stall_cycles);
+	addEstimate(result_fields, "rejected", replicas.rejected);
+	addEstimate(result_fields, "total_bytes", replicas.total_bytes);
+	addEstimate(result_fields, "latency_per_byte", replicas.latency_per_byte);
+	addEstimate(result_fields, "energy_per_byte", replicas.energy_per_byte);
+
+	// Each replica's own aggregates, JSON only
+	vector<Fields> runs(replicas.runs.size());
+	for(int i=0; i < runs.size(); i++) {
+		addField(runs[i], "seed", replicas.runs[i].seed);
+		resultFields(replicas.runs[i], runs[i]);
+	}
+
+	Fields row;
+	if(format == CSV) {
+		flatten(config_fields, "config.", row);
+		flatten(result_fields, "result.", row);
+	}
+
+	ofstream file;
+	bool header;
+	ostream *out = openResults(path, format, row, file, header);
+	if(out == NULL) {
+		return false;
+	}
+
+	if(format == JSON) {
+		*out << "{" << endl;
+		*out << "\t\"config\": "; writeObject(*out, config_fields, "\t"); *out << "," << endl;
+		*out << "\t\"result\": "; writeObject(*out, result_fields, "\t"); *out << "," << endl;
+		*out << "\t\"runs\": "; writeArray(*out, runs); *out << endl;
+		*out << "}" << endl;
+	} else {
+		writeCSV(*out, header, row);
+	}
+
+	return true;
+}
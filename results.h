@@ -0,0 +1,41 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  results.h
+ *
+ *    Description:  Machine-readable report of a run (JSON or CSV)
+ *
+ *        Version:  1.0
+ *        Created:  07/03/2014 02:08:37 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#ifndef _RESULTS_H_
+#define _RESULTS_H_
+
+#include "simulator.h"
+#include "replicas.h"
+
+enum ResultFormat {
+	JSON=0,
+	CSV
+};
+
+// Full configuration, aggregate, per-type, per-rank and per-core results
+// and host timing. JSON writes one object; CSV appends one row per run,
+// with the header only when the file is empty, so many runs can share a
+// file. Path "-" is stdout. False if the file cannot be opened, or if a CSV
+// file already holds a header other than this run's (the per-rank and
+// per-core columns follow -r and -c).
+bool writeResults(const char *path, ResultFormat format, const SimConfig &config, const SimResult &result);
+
+// Replica runs : the configuration (seed of the first replica) and mean
+// and 95% CI of every aggregate, plus in JSON each replica's aggregates
+bool writeReplicaResults(const char *path, ResultFormat format, const SimConfig &config, const ReplicaResult &replicas);
+
+#endif
@@ -0,0 +1,67 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  ringqueue.h
+ *
+ *    Description:  Fixed-capacity FIFO on a power-of-two ring buffer
+ *
+ *        Version:  1.0
+ *        Created:  07/01/2014 09:36:14 AM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#ifndef _RINGQUEUE_H_
+#define _RINGQUEUE_H_
+
+#include <vector>
+
+using namespace std;
+
+// Storage is allocated once, push() on a full queue is refused
+template<class T>
+class RingQueue {
+private:
+	vector<T> slots;
+	unsigned int mask;
+	unsigned int head;  // Index of the front element
+	unsigned int count;
+
+public:
+	// Capacity is rounded up to a power of two
+	RingQueue(unsigned int capacity = 1) {
+		unsigned int size = 1;
+		while(size < capacity) size <<= 1;
+
+		slots.resize(size);
+		mask = size - 1;
+		head = 0;
+		count = 0;
+	}
+
+	bool empty() const { return count == 0; }
+	bool full() const { return count == slots.size(); }
+	unsigned int size() const { return count; }
+	unsigned int capacity() const { return slots.size(); }
+
+	T &front() { return slots[head]; }
+
+	bool push(const T &value) {
+		if(full()) return false;
+
+		slots[(head + count) & mask] = value;
+		count++;
+		return true;
+	}
+
+	void pop() {
+		head = (head + 1) & mask;
+		count--;
+	}
+};
+
+#endif
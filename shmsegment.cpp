@@ -0,0 +1,117 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  shmsegment.cpp
+ *
+ *    Description:  Layout and seqlock access of the live-stats shared-memory segment
+ *
+ *        Version:  1.0
+ *        Created:  06/27/2014 02:24:51 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "shmsegment.h"
+
+using namespace std;
+
+const unsigned int SHM_READ_RETRIES = 1000;
+
+ShmSegment *createShmStats(const char *name) {
+	int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+	if(fd < 0) {
+		cerr << "Cannot create shared memory segment " << name << endl;
+		return NULL;
+	}
+
+	if(ftruncate(fd, sizeof(ShmSegment)) < 0) {
+		cerr << "Cannot size shared memory segment " << name << endl;
+		close(fd);
+		shm_unlink(name);
+		return NULL;
+	}
+
+	void *addr = mmap(NULL, sizeof(ShmSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(addr == MAP_FAILED) {
+		cerr << "Cannot map shared memory segment " << name << endl;
+		shm_unlink(name);
+		return NULL;
+	}
+
+	ShmSegment *segment = (ShmSegment *) addr;
+	memset(segment, 0, sizeof(ShmSegment));
+	segment->snapshot.magic = SHM_MAGIC;
+
+	return segment;
+}
+
+void removeShmStats(const char *name, ShmSegment *segment) {
+	munmap(segment, sizeof(ShmSegment));
+	shm_unlink(name);
+}
+
+void writeShmStats(ShmSegment *segment, const ShmSnapshot &snapshot) {
+	segment->seq++;
+	__sync_synchronize();
+
+	memcpy(&segment->snapshot, &snapshot, sizeof(ShmSnapshot));
+	segment->snapshot.magic = SHM_MAGIC;
+
+	__sync_synchronize();
+	segment->seq++;
+}
+
+ShmSegment *attachShmStats(const char *name) {
+	int fd = shm_open(name, O_RDONLY, 0);
+	if(fd < 0) {
+		return NULL;
+	}
+
+	void *addr = mmap(NULL, sizeof(ShmSegment), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(addr == MAP_FAILED) {
+		return NULL;
+	}
+
+	ShmSegment *segment = (ShmSegment *) addr;
+	if(segment->snapshot.magic != SHM_MAGIC) {
+		munmap(addr, sizeof(ShmSegment));
+		return NULL;
+	}
+
+	return segment;
+}
+
+void detachShmStats(ShmSegment *segment) {
+	munmap(segment, sizeof(ShmSegment));
+}
+
+bool readShmStats(const ShmSegment *segment, ShmSnapshot &snapshot) {
+	for(int i=0; i < SHM_READ_RETRIES; i++) {
+		unsigned int before = segment->seq;
+		if(before & 1) {
+			continue; // Writer in the middle of an update
+		}
+		__sync_synchronize();
+
+		memcpy(&snapshot, (const void *) &segment->snapshot, sizeof(ShmSnapshot));
+
+		__sync_synchronize();
+		if(segment->seq == before) {
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,64 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  shmsegment.h
+ *
+ *    Description:  Layout and seqlock access of the live-stats shared-memory segment
+ *
+ *        Version:  1.0
+ *        Created:  06/27/2014 02:09:22 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#ifndef _SHMSEGMENT_H_
+#define _SHMSEGMENT_H_
+
+// Kept free of the simulator headers so readers link only this and -lrt
+
+const unsigned int SHM_MAGIC = 0x6864726d; // "hdrm"
+const unsigned int SHM_NUM_TYPES = 2;      // Memory types, as NUM_TYPES in controller.h
+const unsigned int SHM_MAX_RANKS = 64;     // Ranks beyond this are not published
+const char SHM_DEFAULT_NAME[] = "/hdram";
+
+// Layout of the segment. The writer makes seq odd, updates the fields and
+// makes it even again; a reader retries until it sees the same even seq
+// before and after its copy.
+struct ShmSnapshot {
+	unsigned int magic;
+	unsigned int num_ranks; // Published ranks per type
+	unsigned long int cycle;
+	unsigned long int end_cycle; // Generation plus drain window
+	unsigned int total_access;
+	float avg_latency;
+	float avg_energy;
+	bool done;
+
+	unsigned int backlog[SHM_NUM_TYPES][SHM_MAX_RANKS];
+	unsigned int status[SHM_NUM_TYPES][SHM_MAX_RANKS];
+};
+
+struct ShmSegment {
+	volatile unsigned int seq;
+	ShmSnapshot snapshot;
+};
+
+// Writer side. NULL if the segment cannot be created.
+ShmSegment *createShmStats(const char *name);
+void removeShmStats(const char *name, ShmSegment *segment); // Unmaps and unlinks
+
+// Copy snapshot into the segment under the seqlock, never waits on readers
+void writeShmStats(ShmSegment *segment, const ShmSnapshot &snapshot);
+
+// Reader side. NULL if the segment does not exist or is not ours.
+ShmSegment *attachShmStats(const char *name);
+void detachShmStats(ShmSegment *segment);
+
+// Consistent copy of the segment, false if the writer kept it busy
+bool readShmStats(const ShmSegment *segment, ShmSnapshot &snapshot);
+
+#endif
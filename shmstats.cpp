@@ -0,0 +1,65 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  shmstats.cpp
+ *
+ *    Description:  Publishes live simulation counters to the shared-memory segment
+ *
+ *        Version:  1.0
+ *        Created:  06/27/2014 02:31:10 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#include <cstring>
+
+#include "shmstats.h"
+
+using namespace std;
+
+ShmPublisher::ShmPublisher(const char *name) {
+	strncpy(this->name, name, sizeof(this->name) - 1);
+	this->name[sizeof(this->name) - 1] = '\0';
+	segment = createShmStats(name);
+}
+
+ShmPublisher::~ShmPublisher() {
+	if(segment == NULL) return;
+
+	removeShmStats(name, segment);
+}
+
+bool ShmPublisher::isOpen() {
+	return segment != NULL;
+}
+
+void ShmPublisher::publish(Controller *controller, unsigned long int cycle, unsigned long int end_cycle, bool done) {
+	if(segment == NULL) return;
+
+	// Gather first so the write side of the seqlock stays short
+	ShmSnapshot snapshot;
+	memset(&snapshot, 0, sizeof(ShmSnapshot));
+
+	unsigned int num_ranks = controller->numRanks();
+	if(num_ranks > SHM_MAX_RANKS) num_ranks = SHM_MAX_RANKS;
+
+	snapshot.num_ranks = num_ranks;
+	snapshot.cycle = cycle;
+	snapshot.end_cycle = end_cycle;
+	snapshot.total_access = controller->totalAccess();
+	snapshot.avg_latency = controller->avgLatency();
+	snapshot.avg_energy = controller->avgEnergy();
+	snapshot.done = done;
+	for(int i=0; i < NUM_TYPES && i < SHM_NUM_TYPES; i++) {
+		for(int j=0; j < num_ranks; j++) {
+			snapshot.backlog[i][j] = controller->rankBacklog(i, j);
+			snapshot.status[i][j] = controller->rankStatus(i, j);
+		}
+	}
+
+	writeShmStats(segment, snapshot);
+}
@@ -0,0 +1,38 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  shmstats.h
+ *
+ *    Description:  Publishes live simulation counters to the shared-memory segment
+ *
+ *        Version:  1.0
+ *        Created:  06/27/2014 02:17:45 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#ifndef _SHMSTATS_H_
+#define _SHMSTATS_H_
+
+#include "controller.h"
+#include "shmsegment.h"
+
+// Simulator side. publish() never waits on readers.
+class ShmPublisher {
+private:
+	char name[256];
+	ShmSegment *segment;
+
+public:
+	ShmPublisher(const char *name);
+	~ShmPublisher(); // Unlinks the segment
+
+	bool isOpen();
+	void publish(Controller *controller, unsigned long int cycle, unsigned long int end_cycle, bool done);
+};
+
+#endif
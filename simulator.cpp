@@ -0,0 +1,204 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  simulator.cpp
+ *
+ *    Description:  Simulation driver (cores + controller)
+ *
+ *        Version:  1.0
+ *        Created:  06/16/2014 11:12:47 AM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <time.h>
+
+#include "simulator.h"
+#include "core.h"
+#include "shmstats.h"
+
+using namespace std;
+
+void defaultSimConfig(SimConfig &config) {
+	config.warmup_time = 0;
+	config.sim_time = 10000;
+	config.num_cores = 4;
+	config.mem_intensity = 0.05;
+	config.type1_intensity = 0.5;
+	config.type2_intensity = 0.5;
+	config.page_skew = 1;
+	config.max_bursts = 1;
+	config.seed = 0;
+	config.shm_name = NULL;
+	config.shm_interval = 10000;
+
+	defaultControllerConfig(config.ctrl);
+}
+
+static bool anyStalled(Core **cores, unsigned int num_cores) {
+	for(int i=0; i < num_cores; i++) {
+		if(cores[i]->isStalled()) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool runSimulation(const SimConfig &config, SimResult &result, bool verbose) {
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	// Simulator initialization
+	ControllerConfig ctrl = config.ctrl;
+	ctrl.num_cores = config.num_cores;
+	Controller *controller = createController(ctrl);
+	if(controller == NULL) {
+		return false;
+	}
+
+	unsigned int seed = config.seed;
+	if(seed == 0) seed = time(NULL);
+	result.seed = seed;
+
+	Core **cores = new Core *[config.num_cores];
+	for(int i=0; i < config.num_cores; i++) {
+		cores[i] = new Core(controller, i, config.mem_intensity, config.type1_intensity, config.type2_intensity,
+				config.ctrl.num_ranks, config.ctrl.num_banks, config.ctrl.num_pages, config.page_skew,
+				config.max_bursts, seed + i);
+	}
+
+	unsigned long int gen_time = config.warmup_time + config.sim_time;
+	unsigned long int end_time = gen_time + 2*config.sim_time;
+	unsigned long int heartbeat = config.sim_time / 10;
+	if(heartbeat == 0) heartbeat = 1;
+
+	ShmPublisher *publisher = NULL;
+	unsigned long int shm_interval = (config.shm_interval != 0) ? config.shm_interval : 1;
+	if(config.shm_name != NULL) {
+		publisher = new ShmPublisher(config.shm_name);
+	}
+
+	// Simulation Loop
+	unsigned long int cycle = 0;
+	for(; cycle < gen_time; cycle++) {
+		if(cycle == config.warmup_time && config.warmup_time != 0) {
+			controller->resetStats();
+			for(int i=0; i < config.num_cores; i++) {
+				cores[i]->resetStats();
+			}
+			if(verbose) cout << "warmup done : " << cycle << endl;
+		}
+
+		for(int i=0; i < config.num_cores; i++) {
+			cores[i]->clockTick();
+		}
+
+		controller->clockTick();
+
+		if(publisher != NULL && cycle % shm_interval == 0) {
+			publisher->publish(controller, cycle, end_time, false);
+		}
+
+		// Heartbeat
+		if(verbose && cycle % heartbeat == 0) {
+			cout << "cycle : " << cycle << endl;
+		}
+	}
+
+	// Drain, stalled cores still hand over the request they hold
+	for(; cycle < end_time && !(controller->isQuiescent() && !anyStalled(cores, config.num_cores)); cycle++) {
+		for(int i=0; i < config.num_cores; i++) {
+			cores[i]->drainTick();
+		}
+
+		controller->clockTick();
+
+		if(publisher != NULL && cycle % shm_interval == 0) {
+			publisher->publish(controller, cycle, end_time, false);
+		}
+
+		// Heartbeat
+		if(verbose && cycle % heartbeat == 0) {
+			cout << "cycle : " << cycle << endl;
+		}
+	}
+
+	result.ticked_cycles = cycle;
+	result.skipped_cycles = end_time - cycle;
+	controller->skipCycles(result.skipped_cycles);
+
+	if(publisher != NULL) {
+		publisher->publish(controller, end_time, end_time, true);
+		delete publisher;
+	}
+
+	result.total_access = controller->totalAccess();
+	result.migration_access = controller->totalMigrationAccess();
+	result.promotions = controller->numPromotions();
+	result.demotions = controller->numDemotions();
+	result.avg_latency = controller->avgLatency();
+	result.p99_latency = controller->latencyPercentile(0.99);
+	result.avg_energy = controller->avgEnergy();
+	result.ed_product = result.avg_latency * result.avg_energy;
+	result.backpressure = controller->numBackpressure();
+	result.refreshes = controller->numRefreshes();
+	result.total_bytes = controller->totalBytes();
+	result.latency_per_byte = controller->latencyPerByte();
+	result.energy_per_byte = controller->energyPerByte();
+
+	for(int i=0; i < NUM_TYPES; i++) {
+		result.type_access[i] = controller->typeAccess(i);
+		result.type_latency[i] = controller->typeLatency(i);
+
+		result.rank_result[i].resize(config.ctrl.num_ranks);
+		for(int j=0; j < config.ctrl.num_ranks; j++) {
+			DRAM *rank = controller->rankOf(i, j);
+			RankResult &rank_result = result.rank_result[i][j];
+
+			rank_result.access = rank->numAccess();
+			rank_result.migration_access = rank->numMigrationAccess();
+			rank_result.avg_latency = rank->avgLatency();
+			rank_result.active_cycles = rank->activeCycles();
+			rank_result.idle_cycles = rank->idleCycles();
+			rank_result.power_down_cycles = rank->powerDownCycles();
+			rank_result.self_refresh_cycles = rank->selfRefreshCycles();
+			rank_result.refreshes = rank->numRefreshes();
+			rank->energyBreakdown(rank_result.energy);
+		}
+	}
+
+	result.core_access.resize(config.num_cores);
+	result.core_latency.resize(config.num_cores);
+	result.core_bandwidth.resize(config.num_cores);
+	result.core_stall.resize(config.num_cores);
+	result.stall_cycles = 0;
+	result.rejected = 0;
+	for(int i=0; i < config.num_cores; i++) {
+		result.core_access[i] = controller->coreAccess(i);
+		result.core_latency[i] = controller->coreLatency(i);
+		result.core_bandwidth[i] = controller->coreBandwidth(i, config.sim_time);
+		result.core_stall[i] = cores[i]->stallCycles();
+		result.stall_cycles += cores[i]->stallCycles();
+		result.rejected += cores[i]->numRejected();
+	}
+
+	// Free heap
+	for(int i=0; i < config.num_cores; i++) {
+		delete cores[i];
+	}
+	delete [] cores;
+	delete controller;
+
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	result.wall_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	result.cycles_per_sec = (result.wall_time > 0) ? result.ticked_cycles / result.wall_time : 0;
+
+	return true;
+}
@@ -0,0 +1,103 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  simulator.h
+ *
+ *    Description:  Simulation driver (cores + controller)
+ *
+ *        Version:  1.0
+ *        Created:  06/16/2014 11:05:32 AM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#ifndef _SIMULATOR_H_
+#define _SIMULATOR_H_
+
+#include <vector>
+
+#include "controller.h"
+
+using namespace std;
+
+struct SimConfig {
+	unsigned long int warmup_time; // Cycles generated before stats are reset
+	unsigned long int sim_time;    // Measured cycles of generation
+	unsigned int num_cores;
+	float mem_intensity;
+	float type1_intensity;
+	float type2_intensity;
+	float page_skew; // Access skew over ctrl.num_pages
+	unsigned int max_bursts; // Requests span 1..max_bursts bursts of BURST_BYTES
+	unsigned int seed; // 0 : seed from the wall clock
+
+	// Live stats
+	const char *shm_name;            // Shared-memory segment to publish into (NULL : off)
+	unsigned long int shm_interval;  // Cycles between publications
+
+	ControllerConfig ctrl;
+};
+
+struct RankResult {
+	unsigned int access;
+	unsigned int migration_access;
+	float avg_latency;
+	unsigned long int active_cycles;
+	unsigned long int idle_cycles;
+	unsigned long int power_down_cycles;
+	unsigned long int self_refresh_cycles;
+	unsigned long int refreshes;
+	EnergyBreakdown energy;
+};
+
+struct SimResult {
+	unsigned int seed; // Seed actually used
+	unsigned int total_access;
+	unsigned int migration_access;
+	unsigned long int promotions;
+	unsigned long int demotions;
+	float avg_latency;
+	float p99_latency;
+	float avg_energy;
+	float ed_product;
+	unsigned long int backpressure; // Dispatches refused by a full bank queue
+	unsigned long int refreshes;
+	unsigned long int stall_cycles; // Core cycles stalled on a full controller
+	unsigned long int rejected;     // Requests the controller refused at least once
+	unsigned long int total_bytes;  // Demand bytes moved
+	float latency_per_byte;
+	float energy_per_byte;
+
+	// Per memory type
+	unsigned int type_access[NUM_TYPES];
+	float type_latency[NUM_TYPES];
+
+	// Per memory type, per rank
+	vector<RankResult> rank_result[NUM_TYPES];
+
+	// Per core
+	vector<unsigned long int> core_access;
+	vector<float> core_latency;
+	vector<float> core_bandwidth; // Accesses per cycle of the measured generation window
+	vector<unsigned long int> core_stall;
+
+	unsigned long int ticked_cycles;  // Cycles actually simulated
+	unsigned long int skipped_cycles; // Quiescent cycles accounted in bulk
+
+	double wall_time;     // Host seconds for the whole run
+	float cycles_per_sec; // Ticked cycles per host second, bulk-skipped ones excluded
+};
+
+void defaultSimConfig(SimConfig &config);
+
+// Generate for warmup_time + sim_time cycles, then drain until the
+// controller is quiescent. Stats cover the measurement phase plus a drain
+// window of 2*sim_time cycles, the tail of which is accounted in bulk.
+// False, with result untouched, if the policy pair is not registered.
+bool runSimulation(const SimConfig &config, SimResult &result, bool verbose);
+
+#endif
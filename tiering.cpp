@@ -0,0 +1,156 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  tiering.cpp
+ *
+ *    Description:  Page-granularity hot/cold tiering between memory types
+ *
+ *        Version:  1.0
+ *        Created:  06/21/2014 02:51:40 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#include <algorithm>
+
+#include "tiering.h"
+
+struct ByCount {
+	const vector<unsigned int> &count;
+	bool descending;
+
+	ByCount(const vector<unsigned int> &count_, bool descending_) : count(count_), descending(descending_) {}
+
+	bool operator()(unsigned int a, unsigned int b) const {
+		return descending ? (count[a] > count[b]) : (count[a] < count[b]);
+	}
+};
+
+TierManager::TierManager(unsigned int num_pages_, unsigned int hot_threshold_, unsigned int fast_capacity_,
+		unsigned int max_migrations_) {
+	num_pages = num_pages_;
+	hot_threshold = hot_threshold_;
+	fast_capacity = fast_capacity_;
+	max_migrations = max_migrations_;
+
+	access_count.resize(num_pages, 0);
+	tier.resize(num_pages, UNMAPPED);
+	moving.resize(num_pages, false);
+	fast_pages = 0;
+
+	num_promotions = 0;
+	num_demotions = 0;
+}
+
+TierManager::~TierManager() {
+}
+
+unsigned int TierManager::access(unsigned int page, unsigned int type) {
+	if(tier[page] == UNMAPPED) {
+		if(type == 0 && fast_pages < fast_capacity) {
+			tier[page] = 0;
+			fast_pages++;
+		} else {
+			tier[page] = 1;
+		}
+	}
+
+	if(access_count[page] != (unsigned int) -1) {
+		access_count[page]++;
+	}
+
+	return tier[page];
+}
+
+void TierManager::rebalance(vector<Migration> &migrations) {
+	vector<unsigned int> hot;  // Low-power pages worth promoting
+	vector<unsigned int> fast; // Fast pages, eviction candidates
+
+	for(int i=0; i < num_pages; i++) {
+		if(moving[i]) {
+			continue;
+		}
+
+		if(tier[i] == 1 && access_count[i] >= hot_threshold) {
+			hot.push_back(i);
+		} else if(tier[i] == 0) {
+			fast.push_back(i);
+		}
+	}
+
+	sort(hot.begin(), hot.end(), ByCount(access_count, true));
+	sort(fast.begin(), fast.end(), ByCount(access_count, false));
+
+	Migration migration;
+	unsigned int victim = 0;
+
+	// Pages that went untouched for an epoch move back to the low-power type
+	for(; victim < fast.size() && access_count[fast[victim]] == 0 && migrations.size() < max_migrations; victim++) {
+		migration.page = fast[victim];
+		migration.from = 0;
+		migration.to = 1;
+		migrations.push_back(migration);
+
+		moving[fast[victim]] = true;
+		fast_pages--;
+		num_demotions++;
+	}
+
+	for(int i=0; i < hot.size() && migrations.size() < max_migrations; i++) {
+		unsigned int page = hot[i];
+
+		if(fast_pages >= fast_capacity) {
+			// Only evict a page that is clearly colder
+			if(victim >= fast.size() || access_count[fast[victim]] * 2 >= access_count[page]
+					|| migrations.size() + 2 > max_migrations) {
+				break;
+			}
+
+			migration.page = fast[victim];
+			migration.from = 0;
+			migration.to = 1;
+			migrations.push_back(migration);
+
+			moving[fast[victim]] = true;
+			fast_pages--;
+			num_demotions++;
+			victim++;
+		}
+
+		migration.page = page;
+		migration.from = 1;
+		migration.to = 0;
+		migrations.push_back(migration);
+
+		moving[page] = true;
+		fast_pages++;
+		num_promotions++;
+	}
+
+	for(int i=0; i < num_pages; i++) {
+		access_count[i] >>= 1;
+	}
+}
+
+// fast_pages already counts the page against its destination
+void TierManager::finishMigration(unsigned int page, unsigned int type) {
+	tier[page] = type;
+	moving[page] = false;
+}
+
+void TierManager::resetStats() {
+	num_promotions = 0;
+	num_demotions = 0;
+}
+
+unsigned long int TierManager::numPromotions() {
+	return num_promotions;
+}
+
+unsigned long int TierManager::numDemotions() {
+	return num_demotions;
+}
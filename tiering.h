@@ -0,0 +1,72 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  tiering.h
+ *
+ *    Description:  Page-granularity hot/cold tiering between memory types
+ *
+ *        Version:  1.0
+ *        Created:  06/21/2014 02:37:18 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#ifndef _TIERING_H_
+#define _TIERING_H_
+
+#include <vector>
+
+using namespace std;
+
+const unsigned char UNMAPPED = 0xff;
+
+struct Migration {
+	unsigned int page;
+	unsigned int from; // Source type
+	unsigned int to;   // Destination type
+};
+
+class TierManager {
+private:
+	vector<unsigned int> access_count; // Decayed per epoch
+	vector<unsigned char> tier;        // Type holding the page, UNMAPPED until first touch
+	vector<bool> moving;               // Migration issued, data not yet at the destination
+
+	unsigned int fast_pages; // Pages currently held by type 0
+
+	// Config
+	unsigned int num_pages;
+	unsigned int hot_threshold;
+	unsigned int fast_capacity;
+	unsigned int max_migrations;
+
+	// Stats
+	unsigned long int num_promotions;
+	unsigned long int num_demotions;
+
+public:
+	TierManager(unsigned int num_pages_, unsigned int hot_threshold_, unsigned int fast_capacity_,
+			unsigned int max_migrations_);
+	~TierManager();
+
+	// Count a demand access and return the type holding the page. The first
+	// touch places the page on the requested type.
+	unsigned int access(unsigned int page, unsigned int type);
+
+	// Promote hot pages, demote cold ones, then halve every counter. Pages
+	// already moving are left alone. The data movement is left to the
+	// caller; a page keeps mapping to its source type until finishMigration().
+	void rebalance(vector<Migration> &migrations);
+	void finishMigration(unsigned int page, unsigned int type);
+
+	// Placement and access counts are state, not stats, and are kept
+	void resetStats();
+	unsigned long int numPromotions();
+	unsigned long int numDemotions();
+};
+
+#endif
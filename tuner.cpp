@@ -0,0 +1,122 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  tuner.cpp
+ *
+ *    Description:  Watermark/timeout auto-tuner (successive halving)
+ *
+ *        Version:  1.0
+ *        Created:  06/18/2014 04:52:36 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <time.h>
+
+#include "tuner.h"
+#include "parallel.h"
+
+using namespace std;
+
+const unsigned int tune_watermarks[] = { 1, 2, 4, 8, 16, 32, 64 };
+const unsigned long int tune_timeouts[] = { 0, 250, 500, 1000, 2000, 4000 };
+
+struct TuneRound {
+	SimConfig config;
+	vector<TuneCandidate> *candidates;
+};
+
+static void tuneCandidate(unsigned int index, void *arg) {
+	TuneRound *round = (TuneRound *) arg;
+
+	TuneCandidate &candidate = (*round->candidates)[index];
+	SimConfig config = round->config;
+	config.ctrl.pd_wm = candidate.pd_wm;
+	config.ctrl.timeout = candidate.timeout;
+
+	runSimulation(config, candidate.result, false);
+}
+
+// Runs without a single access sort last
+static bool betterCandidate(const TuneCandidate &a, const TuneCandidate &b) {
+	if(a.result.total_access == 0 || b.result.total_access == 0) {
+		return a.result.total_access > b.result.total_access;
+	}
+	return a.result.ed_product < b.result.ed_product;
+}
+
+void defaultTuneConfig(TuneConfig &tune) {
+	tune.base_time = 2000;
+	tune.threads = defaultThreads();
+}
+
+void tunePolicy(const SimConfig &base, const TuneConfig &tune, TuneCandidate &best, bool verbose) {
+	// A knob the policy pair never reads stays at its configured value,
+	// otherwise every value would give an identical candidate
+	vector<unsigned int> watermarks(1, base.ctrl.pd_wm);
+	if(usesWatermark(base.ctrl)) {
+		watermarks.assign(tune_watermarks, tune_watermarks + sizeof(tune_watermarks)/sizeof(tune_watermarks[0]));
+	}
+
+	vector<unsigned long int> timeouts(1, base.ctrl.timeout);
+	if(usesTimeout(base.ctrl)) {
+		timeouts.assign(tune_timeouts, tune_timeouts + sizeof(tune_timeouts)/sizeof(tune_timeouts[0]));
+	}
+
+	vector<TuneCandidate> candidates;
+	for(int i=0; i < watermarks.size(); i++) {
+		// Watermarks the queue capacity never reaches cannot be simulated
+		SimConfig config = base;
+		config.ctrl.pd_wm = watermarks[i];
+		if(!reachesWatermark(config.ctrl)) {
+			continue;
+		}
+
+		for(int j=0; j < timeouts.size(); j++) {
+			TuneCandidate candidate;
+			candidate.pd_wm = watermarks[i];
+			candidate.timeout = timeouts[j];
+			candidates.push_back(candidate);
+		}
+	}
+
+	unsigned int seed = base.seed;
+	if(seed == 0) seed = time(NULL);
+
+	TuneRound round;
+	round.config = base;
+	round.config.warmup_time = 0;
+	round.config.sim_time = tune.base_time;
+	round.candidates = &candidates;
+
+	for(int r=0; ; r++) {
+		round.config.seed = seed + 1000*r;
+
+		parallelFor(candidates.size(), tune.threads, tuneCandidate, &round);
+
+		stable_sort(candidates.begin(), candidates.end(), betterCandidate);
+
+		if(verbose) {
+			cout << "round " << r << " : " << candidates.size() << " candidates x "
+				<< round.config.sim_time << " cycles, best watermark " << candidates[0].pd_wm
+				<< " timeout " << candidates[0].timeout
+				<< " E-D " << candidates[0].result.ed_product << endl;
+		}
+
+		if(candidates.size() == 1) {
+			break;
+		}
+
+		candidates.resize((candidates.size() + 1) / 2);
+		round.config.sim_time *= 2;
+	}
+
+	best = candidates[0];
+}
@@ -0,0 +1,42 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  tuner.h
+ *
+ *    Description:  Watermark/timeout auto-tuner (successive halving)
+ *
+ *        Version:  1.0
+ *        Created:  06/18/2014 04:41:09 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Rakesh Ramesh (Doctoral Candidate), rakeshr1@stanford.edu
+ *
+ * =====================================================================================
+ */
+
+#ifndef _TUNER_H_
+#define _TUNER_H_
+
+#include "simulator.h"
+
+struct TuneConfig {
+	unsigned long int base_time; // Measured cycles per candidate in the first round
+	unsigned int threads;        // Candidates simulated in parallel
+};
+
+struct TuneCandidate {
+	unsigned int pd_wm;
+	unsigned long int timeout;
+	SimResult result; // From the last round the candidate survived
+};
+
+void defaultTuneConfig(TuneConfig &tune);
+
+// Every round simulates the surviving candidates for twice as long as the
+// previous one and keeps the better half by E-D product, until one is left.
+// All candidates of a round see the same request stream. Only the knobs
+// the configured policy pair reads are searched.
+void tunePolicy(const SimConfig &base, const TuneConfig &tune, TuneCandidate &best, bool verbose);
+
+#endif